@@ -8,6 +8,7 @@
  */
 
 #include <Python.h>
+#include <stdlib.h>
 #include "pwquality.h"
 
 #if PY_MAJOR_VERSION >= 3
@@ -19,13 +20,38 @@
 #define PWQLong_AsLong PyInt_AsLong
 #endif
 
+#if PY_VERSION_HEX >= 0x030D0000
+#define HAVE_PYMUTEX
+#endif
+
 static PyObject *PWQError;
 
+/* The checks use an immutable copy of the settings so that they can run
+ * concurrently without the GIL. A change of the settings is done on a new
+ * copy that replaces the current one, the copy is freed when the last
+ * check using it drops its reference. */
 typedef struct {
-        PyObject_HEAD
         pwquality_settings_t *pwq;
+        long refs;
+} PWQSnapshot;
+
+typedef struct {
+        PyObject_HEAD
+        PWQSnapshot *snapshot;
+#ifdef HAVE_PYMUTEX
+        PyMutex lock;          /* serializes the replacement of the snapshot */
+#endif
 } PWQSettings;
 
+#ifdef HAVE_PYMUTEX
+#define SETTINGS_LOCK(_self) PyMutex_Lock(&(_self)->lock)
+#define SETTINGS_UNLOCK(_self) PyMutex_Unlock(&(_self)->lock)
+#else
+/* the GIL is held whenever the snapshot is replaced or referenced */
+#define SETTINGS_LOCK(_self)
+#define SETTINGS_UNLOCK(_self)
+#endif
+
 static PyObject *
 pwqsettings_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
 static void
@@ -161,6 +187,11 @@ static PyGetSetDef pwqsettings_getseters[] = {
                 "Check for substrings of the username of a given length",
                 (void *)PWQ_SETTING_USER_SUBSTR
         },
+        { "oldsubstr",
+                (getter)pwqsettings_getint, (setter)pwqsettings_setint,
+                "Length of substrings shared with the old password that are forbidden",
+                (void *)PWQ_SETTING_OLD_SUBSTR
+        },
         { "badwords",
                 (getter)pwqsettings_getstr, (setter)pwqsettings_setstr,
                 "List of words more than 3 characters long that are forbidden",
@@ -171,6 +202,26 @@ static PyGetSetDef pwqsettings_getseters[] = {
                 "Path to the cracklib dictionary",
                 (void *)PWQ_SETTING_DICT_PATH
         },
+        { "dictpreload",
+                (getter)pwqsettings_getint, (setter)pwqsettings_setint,
+                "Read the dictionary into memory before the first dictionary check",
+                (void *)PWQ_SETTING_DICT_PRELOAD
+        },
+        { "genmodel",
+                (getter)pwqsettings_getstr, (setter)pwqsettings_setstr,
+                "Path to the character transition model for password generation",
+                (void *)PWQ_SETTING_GEN_MODEL
+        },
+        { "nameindex",
+                (getter)pwqsettings_getstr, (setter)pwqsettings_setstr,
+                "Path to the index of the names forbidden in the password",
+                (void *)PWQ_SETTING_NAME_INDEX
+        },
+        { "capturefile",
+                (getter)pwqsettings_getstr, (setter)pwqsettings_setstr,
+                "File the features and timing of every check are appended to",
+                (void *)PWQ_SETTING_CAPTURE_FILE
+        },
         { NULL }  /* Sentinel */
 };
 
@@ -246,6 +297,76 @@ pwqerror(int rc, void *auxerror)
         return NULL;
 }
 
+static PWQSnapshot *
+snapshot_new(pwquality_settings_t *pwq)
+{
+        PWQSnapshot *snapshot;
+
+        if (pwq == NULL)
+                return NULL;
+        snapshot = malloc(sizeof(*snapshot));
+        if (snapshot == NULL) {
+                pwquality_free_settings(pwq);
+                return NULL;
+        }
+        snapshot->pwq = pwq;
+        snapshot->refs = 1;
+        return snapshot;
+}
+
+/* Obtain a reference to the current snapshot. */
+static PWQSnapshot *
+snapshot_get(PWQSettings *self)
+{
+        PWQSnapshot *snapshot;
+
+        SETTINGS_LOCK(self);
+        snapshot = self->snapshot;
+        __atomic_add_fetch(&snapshot->refs, 1, __ATOMIC_RELAXED);
+        SETTINGS_UNLOCK(self);
+        return snapshot;
+}
+
+/* Drop the reference, it can be called without the GIL. */
+static void
+snapshot_put(PWQSnapshot *snapshot)
+{
+        if (__atomic_sub_fetch(&snapshot->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+                pwquality_free_settings(snapshot->pwq);
+                free(snapshot);
+        }
+}
+
+/* Lock the settings and return a copy of them to be modified.
+ * On failure the lock is released and NULL is returned. */
+static PWQSnapshot *
+settings_begin(PWQSettings *self)
+{
+        PWQSnapshot *snapshot;
+
+        SETTINGS_LOCK(self);
+        /* the copy shares the preloaded dictionary and the mapped
+           index of names with the current snapshot */
+        snapshot = snapshot_new(pwquality_copy_settings(self->snapshot->pwq));
+        if (snapshot == NULL)
+                SETTINGS_UNLOCK(self);
+        return snapshot;
+}
+
+/* Publish the modified copy if rc is not an error and unlock the settings. */
+static void
+settings_commit(PWQSettings *self, PWQSnapshot *snapshot, int rc)
+{
+        if (rc >= 0) {
+                PWQSnapshot *old = self->snapshot;
+
+                self->snapshot = snapshot;
+                snapshot = old;
+        }
+        SETTINGS_UNLOCK(self);
+        snapshot_put(snapshot);
+}
+
 static PyObject *
 pwqsettings_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
@@ -253,8 +374,8 @@ pwqsettings_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 
         self = (PWQSettings *)type->tp_alloc(type, 0);
         if (self) {
-                self->pwq = pwquality_default_settings();
-                if (self->pwq == NULL) {
+                self->snapshot = snapshot_new(pwquality_default_settings());
+                if (self->snapshot == NULL) {
                         Py_DECREF(self);
                         return PyErr_NoMemory();
                 }
@@ -265,17 +386,22 @@ pwqsettings_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 static void
 pwqsettings_dealloc(PWQSettings *self)
 {
-        pwquality_free_settings(self->pwq);
+        if (self->snapshot)
+                snapshot_put(self->snapshot);
         Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
 static PyObject *
 pwqsettings_getint(PWQSettings *self, void *setting)
 {
+        PWQSnapshot *snapshot;
         int value;
         int rc;
 
-        if ((rc = pwquality_get_int_value(self->pwq, (int)(ssize_t)setting, &value)) < 0) {
+        snapshot = snapshot_get(self);
+        rc = pwquality_get_int_value(snapshot->pwq, (int)(ssize_t)setting, &value);
+        snapshot_put(snapshot);
+        if (rc < 0) {
                 return pwqerror(rc, NULL);
         }
         return PWQLong_FromLong((long)value);
@@ -284,13 +410,20 @@ pwqsettings_getint(PWQSettings *self, void *setting)
 static int
 pwqsettings_setint(PWQSettings *self, PyObject *value, void *setting)
 {
+        PWQSnapshot *snapshot;
         long l;
         int rc;
 
         l = PWQLong_AsLong(value);
         if (PyErr_Occurred() == NULL) {
-                if ((rc = pwquality_set_int_value(self->pwq,
-                        (int)(ssize_t)setting, (int)l)) < 0) {
+                if ((snapshot = settings_begin(self)) == NULL) {
+                        PyErr_NoMemory();
+                        return -1;
+                }
+                rc = pwquality_set_int_value(snapshot->pwq,
+                        (int)(ssize_t)setting, (int)l);
+                settings_commit(self, snapshot, rc);
+                if (rc < 0) {
                         pwqerror(rc, NULL);
                         return -1;
                 }
@@ -302,39 +435,49 @@ pwqsettings_setint(PWQSettings *self, PyObject *value, void *setting)
 static PyObject *
 pwqsettings_getstr(PWQSettings *self, void *setting)
 {
+        PWQSnapshot *snapshot;
+        PyObject *strobj;
         const char *value;
         int rc;
 
-        if ((rc = pwquality_get_str_value(self->pwq, (int)(ssize_t)setting, &value)) < 0) {
+        snapshot = snapshot_get(self);
+        if ((rc = pwquality_get_str_value(snapshot->pwq, (int)(ssize_t)setting, &value)) < 0) {
+                snapshot_put(snapshot);
                 return pwqerror(rc, NULL);
         }
         if (value == NULL) {
+                snapshot_put(snapshot);
                 Py_INCREF(Py_None);
                 return Py_None;
         }
 #ifdef IS_PY3K
-        return PyUnicode_FromString(value);
+        strobj = PyUnicode_FromString(value);
 #else
-        return PyString_FromString(value);
+        strobj = PyString_FromString(value);
 #endif
+        snapshot_put(snapshot);
+        return strobj;
 }
 
 static int
 pwqsettings_setstr(PWQSettings *self, PyObject *value, void *setting)
 {
+        PWQSnapshot *snapshot;
+        PyObject *value_as_bytes = NULL;
         const char *s = NULL;
         int rc;
 
         if (value != (PyObject *)Py_None) {
 #ifdef IS_PY3K
                 if (PyUnicode_Check(value)) {
-                        PyObject *value_as_bytes = PyUnicode_AsUTF8String(value);
+                        value_as_bytes = PyUnicode_AsUTF8String(value);
                         if (!value_as_bytes)
                                 return -1;
                         s = PyBytes_AsString(value_as_bytes);
-                        Py_DECREF(value_as_bytes);
-                        if (!s)
+                        if (!s) {
+                                Py_DECREF(value_as_bytes);
                                 return -1;
+                        }
                 } else {
                         PyErr_SetString(PyExc_TypeError, "expected unicode string");
                 }
@@ -344,26 +487,40 @@ pwqsettings_setstr(PWQSettings *self, PyObject *value, void *setting)
         }
 
         if (PyErr_Occurred() == NULL) {
-                if ((rc = pwquality_set_str_value(self->pwq,
-                        (int)(ssize_t)setting, s)) < 0) {
+                if ((snapshot = settings_begin(self)) == NULL) {
+                        Py_XDECREF(value_as_bytes);
+                        PyErr_NoMemory();
+                        return -1;
+                }
+                rc = pwquality_set_str_value(snapshot->pwq,
+                        (int)(ssize_t)setting, s);
+                settings_commit(self, snapshot, rc);
+                Py_XDECREF(value_as_bytes);
+                if (rc < 0) {
                         pwqerror(rc, NULL);
                         return -1;
                 }
                 return 0;
         }
+        Py_XDECREF(value_as_bytes);
         return -1;
 }
 
 static PyObject *
 read_config(PWQSettings *self, PyObject *args)
 {
+        PWQSnapshot *snapshot;
         char *cfgfile = NULL;
         void *auxerror;
         int rc;
 
         if (!PyArg_ParseTuple(args, "|s", &cfgfile))
                 return NULL;
-        if ((rc = pwquality_read_config(self->pwq, cfgfile, &auxerror)) < 0) {
+        if ((snapshot = settings_begin(self)) == NULL)
+                return PyErr_NoMemory();
+        rc = pwquality_read_config(snapshot->pwq, cfgfile, &auxerror);
+        settings_commit(self, snapshot, rc);
+        if (rc < 0) {
                 return pwqerror(rc, auxerror);
         }
         Py_INCREF(Py_None);
@@ -373,12 +530,17 @@ read_config(PWQSettings *self, PyObject *args)
 static PyObject *
 set_option(PWQSettings *self, PyObject *args)
 {
+        PWQSnapshot *snapshot;
         char *option;
         int rc;
 
         if (!PyArg_ParseTuple(args, "s", &option))
                 return NULL;
-        if ((rc = pwquality_set_option(self->pwq, option)) < 0) {
+        if ((snapshot = settings_begin(self)) == NULL)
+                return PyErr_NoMemory();
+        rc = pwquality_set_option(snapshot->pwq, option);
+        settings_commit(self, snapshot, rc);
+        if (rc < 0) {
                 return pwqerror(rc, NULL);
         }
         Py_INCREF(Py_None);
@@ -388,6 +550,7 @@ set_option(PWQSettings *self, PyObject *args)
 static PyObject *
 generate(PWQSettings *self, PyObject *args)
 {
+        PWQSnapshot *snapshot;
         int entropy_bits;
         char *password;
         PyObject *passobj;
@@ -395,7 +558,12 @@ generate(PWQSettings *self, PyObject *args)
 
         if (!PyArg_ParseTuple(args, "i", &entropy_bits))
                 return NULL;
-        if ((rc = pwquality_generate(self->pwq, entropy_bits, &password)) < 0) {
+        snapshot = snapshot_get(self);
+        Py_BEGIN_ALLOW_THREADS
+        rc = pwquality_generate(snapshot->pwq, entropy_bits, &password);
+        Py_END_ALLOW_THREADS
+        snapshot_put(snapshot);
+        if (rc < 0) {
                 return pwqerror(rc, NULL);
         }
 
@@ -411,6 +579,7 @@ generate(PWQSettings *self, PyObject *args)
 static PyObject *
 check(PWQSettings *self, PyObject *args)
 {
+        PWQSnapshot *snapshot;
         char *password;
         char *oldpassword = NULL;
         char *username = NULL;
@@ -419,8 +588,13 @@ check(PWQSettings *self, PyObject *args)
 
         if (!PyArg_ParseTuple(args, "s|zz", &password, &oldpassword, &username))
                 return NULL;
-        if ((rc = pwquality_check(self->pwq, password, oldpassword,
-                                  username, &auxerror)) < 0) {
+        snapshot = snapshot_get(self);
+        Py_BEGIN_ALLOW_THREADS
+        rc = pwquality_check(snapshot->pwq, password, oldpassword,
+                             username, &auxerror);
+        Py_END_ALLOW_THREADS
+        snapshot_put(snapshot);
+        if (rc < 0) {
                 return pwqerror(rc, auxerror);
         }
 
@@ -464,6 +638,9 @@ initpwquality(void)
 #endif
         if (module == NULL)
                 INITERROR;
+#ifdef Py_GIL_DISABLED
+        PyUnstable_Module_SetGIL(module, Py_MOD_GIL_NOT_USED);
+#endif
 
         PWQError = PyErr_NewExceptionWithDoc("pwquality.PWQError",
                 "Standard exception thrown from PWQSettings method calls\n\n"
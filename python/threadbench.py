@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Measure how PWQSettings.check() scales with the number of threads
+# sharing one settings object. It is meant to be run under the
+# free-threaded interpreter (python3.13t or later) where the checks
+# run in parallel.
+#
+# See the end of the file for Copyright and License Information
+#
+
+import argparse
+import random
+import string
+import sys
+import threading
+import time
+
+import pwquality
+
+
+def make_inputs(count, seed):
+    rnd = random.Random(seed)
+    chars = string.ascii_letters + string.digits + string.punctuation
+    inputs = []
+    for _ in range(count):
+        password = ''.join(rnd.choice(chars) for _ in range(rnd.randint(6, 24)))
+        old = ''.join(rnd.choice(chars) for _ in range(rnd.randint(6, 24)))
+        inputs.append((password, old))
+    return inputs
+
+
+def worker(settings, inputs, checks, start):
+    start.wait()
+    n = len(inputs)
+    for i in range(checks):
+        password, old = inputs[i % n]
+        try:
+            settings.check(password, old)
+        except pwquality.PWQError:
+            pass
+
+
+def mutator(settings, stop):
+    # keep publishing new settings while the checks run
+    minlen = 8
+    while not stop.is_set():
+        minlen = 17 - minlen
+        settings.minlen = minlen
+        time.sleep(0.001)
+
+
+def run(settings, inputs, threads, checks, mutate):
+    start = threading.Barrier(threads + 1)
+    stop = threading.Event()
+    workers = [threading.Thread(target=worker,
+                                args=(settings, inputs, checks, start))
+               for _ in range(threads)]
+    for t in workers:
+        t.start()
+    if mutate:
+        m = threading.Thread(target=mutator, args=(settings, stop))
+        m.start()
+    start.wait()
+    begin = time.perf_counter()
+    for t in workers:
+        t.join()
+    elapsed = time.perf_counter() - begin
+    if mutate:
+        stop.set()
+        m.join()
+    return threads * checks / elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=
+        'Measure the scaling of PWQSettings.check() over threads')
+    parser.add_argument('-t', '--threads', default='1,2,4,8',
+                        help='comma separated thread counts (default 1,2,4,8)')
+    parser.add_argument('-n', '--checks', type=int, default=50000,
+                        help='checks per thread (default 50000)')
+    parser.add_argument('-d', '--dictcheck', action='store_true',
+                        help='keep the dictionary check enabled')
+    parser.add_argument('-m', '--mutate', action='store_true',
+                        help='change the settings while checking')
+    args = parser.parse_args()
+
+    settings = pwquality.PWQSettings()
+    if not args.dictcheck:
+        settings.dictcheck = 0
+    inputs = make_inputs(4096, 1)
+
+    gil = getattr(sys, '_is_gil_enabled', lambda: True)()
+    print('Python %s, GIL %s' % (sys.version.split()[0],
+                                  'enabled' if gil else 'disabled'))
+    base = None
+    for threads in [int(t) for t in args.threads.split(',')]:
+        rate = run(settings, inputs, threads, args.checks, args.mutate)
+        if base is None:
+            base = rate / threads
+        print('%3d threads: %10.0f checks/s, scaling %5.2f' %
+              (threads, rate, rate / base))
+
+
+if __name__ == '__main__':
+    main()
+
+# Copyright (c) Red Hat, Inc, 2026
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, and the entire permission notice in its entirety,
+#    including the disclaimer of warranties.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 3. The name of the author may not be used to endorse or promote
+#    products derived from this software without specific prior
+#    written permission.
+#
+# ALTERNATIVELY, this product may be distributed under the terms of
+# the GNU General Public License version 2 or later, in which case the
+# provisions of the GPL are required INSTEAD OF the above restrictions.
+#
+# THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+# OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+# INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+# OF THE POSSIBILITY OF SUCH DAMAGE.
@@ -0,0 +1,345 @@
+/*
+ * libpwquality API code for asynchronous password checking
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+struct async_request {
+        struct async_request *next;
+        char *password;
+        char *oldpassword;
+        char *user;
+        void *cookie;
+        int result;
+        void *auxerror;
+};
+
+struct request_queue {
+        struct async_request *head;
+        struct async_request *tail;
+};
+
+struct pwquality_async {
+        pwquality_settings_t *pwq;
+        pthread_mutex_t lock;
+        pthread_cond_t cond;
+        struct request_queue pending;
+        struct request_queue done;
+        pthread_t *threads;
+        int nthreads;
+        int stop;
+        int fd;      /* eventfd, or the read end of the pipe */
+        int wakefd;  /* the write end of the pipe, or fd */
+};
+
+static void
+queue_push(struct request_queue *q, struct async_request *req)
+{
+        req->next = NULL;
+        if (q->tail)
+                q->tail->next = req;
+        else
+                q->head = req;
+        q->tail = req;
+}
+
+static struct async_request *
+queue_pop(struct request_queue *q)
+{
+        struct async_request *req = q->head;
+
+        if (req) {
+                q->head = req->next;
+                if (q->head == NULL)
+                        q->tail = NULL;
+        }
+        return req;
+}
+
+static void
+wipe_free(char *s)
+{
+        if (s) {
+                memset(s, 0, strlen(s));
+                free(s);
+        }
+}
+
+static void
+free_request(struct async_request *req)
+{
+        wipe_free(req->password);
+        wipe_free(req->oldpassword);
+        wipe_free(req->user);
+        free(req);
+}
+
+static void
+signal_completion(pwquality_async_t *async)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+        uint64_t one = 1;
+#else
+        char one = 1;
+#endif
+
+        while (write(async->wakefd, &one, sizeof(one)) < 0 && errno == EINTR);
+}
+
+static void
+clear_completion(pwquality_async_t *async)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+        uint64_t count;
+
+        while (read(async->fd, &count, sizeof(count)) < 0 && errno == EINTR);
+#else
+        char buf[64];
+        ssize_t n;
+
+        do
+                n = read(async->fd, buf, sizeof(buf));
+        while (n > 0 || (n < 0 && errno == EINTR));
+#endif
+}
+
+static int
+open_completion_fd(pwquality_async_t *async)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+        async->fd = async->wakefd = eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+        return async->fd;
+#else
+        int fds[2];
+        int i;
+
+        if (pipe(fds) == -1)
+                return -1;
+
+        for (i = 0; i < 2; i++) {
+                fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+                fcntl(fds[i], F_SETFL, O_NONBLOCK);
+        }
+        async->fd = fds[0];
+        async->wakefd = fds[1];
+        return 0;
+#endif
+}
+
+static void *
+worker(void *arg)
+{
+        pwquality_async_t *async = arg;
+        struct async_request *req;
+
+        pthread_mutex_lock(&async->lock);
+        for (;;) {
+                while (!async->stop && async->pending.head == NULL)
+                        pthread_cond_wait(&async->cond, &async->lock);
+                if (async->stop)
+                        break;
+
+                req = queue_pop(&async->pending);
+                pthread_mutex_unlock(&async->lock);
+
+                req->result = pwquality_check(async->pwq, req->password,
+                        req->oldpassword, req->user, &req->auxerror);
+                wipe_free(req->password);
+                wipe_free(req->oldpassword);
+                wipe_free(req->user);
+                req->password = req->oldpassword = req->user = NULL;
+
+                /* the completion is signalled under the lock so the fd is
+                   readable exactly when there are results to fetch */
+                pthread_mutex_lock(&async->lock);
+                queue_push(&async->done, req);
+                signal_completion(async);
+        }
+        pthread_mutex_unlock(&async->lock);
+
+        return NULL;
+}
+
+/* start the worker threads for the asynchronous checks */
+pwquality_async_t *
+pwquality_async_new(pwquality_settings_t *pwq, int nthreads)
+{
+        pwquality_async_t *async;
+        int i;
+
+        if (nthreads <= 0)
+                nthreads = PWQ_ASYNC_DEFAULT_THREADS;
+
+        async = calloc(1, sizeof(*async));
+        if (async == NULL)
+                return NULL;
+
+        async->pwq = pwq;
+        async->threads = calloc(nthreads, sizeof(*async->threads));
+        if (async->threads == NULL) {
+                free(async);
+                return NULL;
+        }
+
+        if (open_completion_fd(async) < 0) {
+                free(async->threads);
+                free(async);
+                return NULL;
+        }
+
+        pthread_mutex_init(&async->lock, NULL);
+        pthread_cond_init(&async->cond, NULL);
+
+        for (i = 0; i < nthreads; i++) {
+                if (pthread_create(&async->threads[i], NULL, worker, async) != 0)
+                        break;
+                ++async->nthreads;
+        }
+
+        if (async->nthreads == 0) {
+                pwquality_async_free(async);
+                return NULL;
+        }
+
+        return async;
+}
+
+/* file descriptor that is readable when there are completed checks */
+int
+pwquality_async_fd(pwquality_async_t *async)
+{
+        return async->fd;
+}
+
+/* queue the password to be checked by the worker threads */
+int
+pwquality_check_async(pwquality_async_t *async, const char *password,
+        const char *oldpassword, const char *user, void *cookie)
+{
+        struct async_request *req;
+
+        req = calloc(1, sizeof(*req));
+        if (req == NULL)
+                return PWQ_ERROR_MEM_ALLOC;
+
+        req->cookie = cookie;
+        if ((password && (req->password = strdup(password)) == NULL) ||
+            (oldpassword && (req->oldpassword = strdup(oldpassword)) == NULL) ||
+            (user && (req->user = strdup(user)) == NULL)) {
+                free_request(req);
+                return PWQ_ERROR_MEM_ALLOC;
+        }
+
+        pthread_mutex_lock(&async->lock);
+        queue_push(&async->pending, req);
+        pthread_cond_signal(&async->cond);
+        pthread_mutex_unlock(&async->lock);
+
+        return 0;
+}
+
+/* fetch a completed check without blocking */
+int
+pwquality_async_result(pwquality_async_t *async, void **cookie, int *result,
+        void **auxerror)
+{
+        struct async_request *req;
+
+        pthread_mutex_lock(&async->lock);
+        req = queue_pop(&async->done);
+        if (req == NULL)
+                clear_completion(async);
+        pthread_mutex_unlock(&async->lock);
+
+        if (req == NULL)
+                return 0;
+
+        if (cookie)
+                *cookie = req->cookie;
+        if (result)
+                *result = req->result;
+        if (auxerror)
+                *auxerror = req->auxerror;
+        free_request(req);
+        return 1;
+}
+
+/* stop the worker threads and drop the unfetched checks */
+void
+pwquality_async_free(pwquality_async_t *async)
+{
+        struct async_request *req;
+        int i;
+
+        if (async == NULL)
+                return;
+
+        pthread_mutex_lock(&async->lock);
+        async->stop = 1;
+        pthread_cond_broadcast(&async->cond);
+        pthread_mutex_unlock(&async->lock);
+
+        for (i = 0; i < async->nthreads; i++)
+                pthread_join(async->threads[i], NULL);
+
+        while ((req = queue_pop(&async->pending)) != NULL)
+                free_request(req);
+        while ((req = queue_pop(&async->done)) != NULL)
+                free_request(req);
+
+        pthread_cond_destroy(&async->cond);
+        pthread_mutex_destroy(&async->lock);
+        close(async->fd);
+        if (async->wakefd != async->fd)
+                close(async->wakefd);
+        free(async->threads);
+        free(async);
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -0,0 +1,250 @@
+/*
+ * libpwquality API code for checking batches of passwords
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+struct batch_entry {
+        uint64_t hash;
+        char *key;      /* password, old password and user separated by NULs */
+        size_t keylen;
+        int rv;
+        void *auxerror;
+};
+
+struct pwquality_batch {
+        pwquality_settings_t *pwq;
+        unsigned char sipkey[16]; /* random so the table cannot be flooded
+                                     by crafted inputs */
+        struct batch_entry *slots;
+        size_t nslots;
+        size_t nentries;
+        unsigned long checks;
+        unsigned long hits;
+        struct pwq_users *users; /* prefetched GECOS fields or NULL */
+};
+
+/* start a batch of password checks */
+pwquality_batch_t *
+pwquality_batch_new(pwquality_settings_t *pwq)
+{
+        pwquality_batch_t *batch;
+
+        batch = calloc(1, sizeof(*batch));
+        if (batch == NULL)
+                return NULL;
+
+        batch->pwq = pwq;
+        batch->nslots = PWQ_BATCH_MIN_SLOTS;
+        batch->slots = calloc(batch->nslots, sizeof(*batch->slots));
+        if (batch->slots == NULL ||
+            get_entropy_bits((char *)batch->sipkey, sizeof(batch->sipkey) * 8) < 0) {
+                free(batch->slots);
+                free(batch);
+                return NULL;
+        }
+
+        return batch;
+}
+
+static struct batch_entry *
+find_slot(struct batch_entry *slots, size_t nslots, uint64_t hash,
+          const char *key, size_t keylen)
+{
+        size_t i = hash & (nslots - 1);
+
+        while (slots[i].key != NULL) {
+                if (slots[i].hash == hash && slots[i].keylen == keylen &&
+                    memcmp(slots[i].key, key, keylen) == 0)
+                        break;
+                i = (i + 1) & (nslots - 1);
+        }
+        return &slots[i];
+}
+
+static int
+grow_table(pwquality_batch_t *batch)
+{
+        struct batch_entry *slots;
+        size_t nslots = batch->nslots * 2;
+        size_t i;
+
+        slots = calloc(nslots, sizeof(*slots));
+        if (slots == NULL)
+                return -1;
+
+        for (i = 0; i < batch->nslots; i++) {
+                struct batch_entry *e = &batch->slots[i];
+
+                if (e->key != NULL)
+                        *find_slot(slots, nslots, e->hash, e->key, e->keylen) = *e;
+        }
+
+        free(batch->slots);
+        batch->slots = slots;
+        batch->nslots = nslots;
+        return 0;
+}
+
+/* check the password remembering the results of identical inputs */
+int
+pwquality_batch_check(pwquality_batch_t *batch, const char *password,
+        const char *oldpassword, const char *user, void **auxerror)
+{
+        struct batch_entry *e;
+        size_t pwlen, oldlen, userlen, keylen;
+        uint64_t hash;
+        char *key;
+        void *aux = NULL;
+        int rv;
+
+        ++batch->checks;
+
+        if (password == NULL || *password == '\0')
+                return check_with_users(batch->pwq, password, oldpassword,
+                        user, batch->users, auxerror);
+
+        /* NULL and empty old password and user are equivalent */
+        if (oldpassword == NULL)
+                oldpassword = "";
+        if (user == NULL)
+                user = "";
+
+        pwlen = strlen(password);
+        oldlen = strlen(oldpassword);
+        userlen = strlen(user);
+        keylen = pwlen + oldlen + userlen + 3;
+
+        key = malloc(keylen);
+        if (key == NULL)
+                return check_with_users(batch->pwq, password, oldpassword,
+                        user, batch->users, auxerror);
+        memcpy(key, password, pwlen + 1);
+        memcpy(key + pwlen + 1, oldpassword, oldlen + 1);
+        memcpy(key + pwlen + oldlen + 2, user, userlen + 1);
+
+        hash = siphash24(batch->sipkey, key, keylen);
+        e = find_slot(batch->slots, batch->nslots, hash, key, keylen);
+        if (e->key != NULL) {
+                memset(key, 0, keylen);
+                free(key);
+                ++batch->hits;
+                if (auxerror)
+                        *auxerror = e->auxerror;
+                return e->rv;
+        }
+
+        rv = check_with_users(batch->pwq, password, oldpassword, user,
+                batch->users, &aux);
+        if (auxerror)
+                *auxerror = aux;
+
+        /* the memory allocation failures are transient and the
+           auxiliary data of the other errors is never allocated */
+        if (rv == PWQ_ERROR_MEM_ALLOC || batch->nentries >= PWQ_BATCH_MAX_ENTRIES ||
+            ((batch->nentries + 1) * 2 > batch->nslots && grow_table(batch) < 0)) {
+                memset(key, 0, keylen);
+                free(key);
+                return rv;
+        }
+
+        e = find_slot(batch->slots, batch->nslots, hash, key, keylen);
+        e->hash = hash;
+        e->key = key;
+        e->keylen = keylen;
+        e->rv = rv;
+        e->auxerror = aux;
+        ++batch->nentries;
+
+        return rv;
+}
+
+/* read the GECOS fields of all users for the checks of the batch */
+int
+pwquality_batch_prefetch_users(pwquality_batch_t *batch,
+        const char *passwdfile)
+{
+        if (!PWQ_CHECK_SETTING(batch->pwq, gecos_check))
+                return 0;
+
+        if (batch->users == NULL &&
+            (batch->users = users_new()) == NULL)
+                return PWQ_ERROR_MEM_ALLOC;
+
+        return users_load(batch->users, passwdfile);
+}
+
+/* obtain the batch statistics */
+void
+pwquality_batch_stats(pwquality_batch_t *batch, unsigned long *checks,
+        unsigned long *hits)
+{
+        if (checks)
+                *checks = batch->checks;
+        if (hits)
+                *hits = batch->hits;
+}
+
+/* wipe the remembered inputs and free the batch */
+void
+pwquality_batch_free(pwquality_batch_t *batch)
+{
+        size_t i;
+
+        if (batch == NULL)
+                return;
+
+        for (i = 0; i < batch->nslots; i++) {
+                if (batch->slots[i].key) {
+                        memset(batch->slots[i].key, 0, batch->slots[i].keylen);
+                        free(batch->slots[i].key);
+                }
+        }
+        memset(batch->slots, 0, batch->nslots * sizeof(*batch->slots));
+        free(batch->slots);
+        users_free(batch->users);
+        memset(batch, 0, sizeof(*batch));
+        free(batch);
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -0,0 +1,286 @@
+/*
+ * libpwquality API code for capturing the check workload
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+uint64_t
+capture_clock(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* nanoseconds since start, saturated */
+uint32_t
+capture_elapsed(uint64_t start)
+{
+        uint64_t elapsed = capture_clock() - start;
+
+        return elapsed > UINT32_MAX ? UINT32_MAX : elapsed;
+}
+
+static uint16_t
+clamp16(size_t value)
+{
+        return value > UINT16_MAX ? UINT16_MAX : value;
+}
+
+uint64_t
+capture_start(struct pwq_capture_record *rec)
+{
+        struct timespec ts;
+
+        memset(rec, 0, sizeof(*rec));
+        rec->magic = PWQ_CAPTURE_MAGIC;
+        rec->version = PWQ_CAPTURE_VERSION;
+        rec->size = sizeof(*rec);
+        rec->failed_rule = PWQ_RULE_NONE;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        rec->time_ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+
+        return capture_clock();
+}
+
+/* the rule that returns the error */
+static int
+failed_rule(int result)
+{
+        switch (result) {
+        case PWQ_ERROR_CASE_CHANGES_ONLY:
+                return PWQ_RULE_CASE_CHANGES;
+        case PWQ_ERROR_TOO_SIMILAR:
+                return PWQ_RULE_SIMILAR;
+        case PWQ_ERROR_OLD_SUBSTR:
+                return PWQ_RULE_OLD_SUBSTR;
+        case PWQ_ERROR_MIN_DIGITS:
+        case PWQ_ERROR_MIN_UPPERS:
+        case PWQ_ERROR_MIN_LOWERS:
+        case PWQ_ERROR_MIN_OTHERS:
+        case PWQ_ERROR_MIN_LENGTH:
+        case PWQ_ERROR_MAX_CLASS_REPEAT:
+                return PWQ_RULE_SIMPLE;
+        case PWQ_ERROR_ROTATED:
+                return PWQ_RULE_ROTATED;
+        case PWQ_ERROR_MIN_CLASSES:
+                return PWQ_RULE_MIN_CLASSES;
+        case PWQ_ERROR_PALINDROME:
+                return PWQ_RULE_PALINDROME;
+        case PWQ_ERROR_MAX_CONSECUTIVE:
+                return PWQ_RULE_CONSECUTIVE;
+        case PWQ_ERROR_MAX_SEQUENCE:
+                return PWQ_RULE_SEQUENCE;
+        case PWQ_ERROR_USER_CHECK:
+                return PWQ_RULE_USER;
+        case PWQ_ERROR_GECOS_CHECK:
+                return PWQ_RULE_GECOS;
+        case PWQ_ERROR_BAD_WORDS:
+                return PWQ_RULE_BAD_WORDS;
+        case PWQ_ERROR_NAMES:
+        case PWQ_ERROR_NAME_INDEX:
+                return PWQ_RULE_NAMES;
+        case PWQ_ERROR_CRACKLIB_CHECK:
+                return PWQ_RULE_DICT;
+        }
+        return PWQ_RULE_NONE;
+}
+
+/* the order in which password_check() runs the rules */
+static const int rule_order[PWQ_RULES] = {
+        PWQ_RULE_CASE_CHANGES,
+        PWQ_RULE_SIMILAR,
+        PWQ_RULE_OLD_SUBSTR,
+        PWQ_RULE_SIMPLE,
+        PWQ_RULE_ROTATED,
+        PWQ_RULE_MIN_CLASSES,
+        PWQ_RULE_PALINDROME,
+        PWQ_RULE_CONSECUTIVE,
+        PWQ_RULE_SEQUENCE,
+        PWQ_RULE_USER,
+        PWQ_RULE_GECOS,
+        PWQ_RULE_NAMES,
+        PWQ_RULE_BAD_WORDS,
+        PWQ_RULE_DICT
+};
+
+/* the rules are run in order until one of them fails, those that
+ * do not apply to the inputs or settings are skipped */
+static uint32_t
+rules_run(pwquality_settings_t *pwq, int failed, int result,
+        const char *oldpassword, const char *user)
+{
+        uint32_t run = 0;
+        int i, rule;
+
+        if (result == PWQ_ERROR_EMPTY_PASSWORD ||
+            result == PWQ_ERROR_SAME_PASSWORD ||
+            result == PWQ_ERROR_MEM_ALLOC)
+                return 0;
+
+        for (i = 0; i < PWQ_RULES; i++) {
+                rule = rule_order[i];
+                switch (rule) {
+                case PWQ_RULE_CASE_CHANGES:
+                case PWQ_RULE_SIMILAR:
+                case PWQ_RULE_ROTATED:
+                        if (oldpassword == NULL || pwq->diff_ok == 0)
+                                continue;
+                        break;
+                case PWQ_RULE_OLD_SUBSTR:
+                        if (oldpassword == NULL || pwq->diff_ok == 0 ||
+                            pwq->old_substr < PWQ_MIN_WORD_LENGTH)
+                                continue;
+                        break;
+                case PWQ_RULE_USER:
+                        if (user == NULL || !pwq->user_check)
+                                continue;
+                        break;
+                case PWQ_RULE_GECOS:
+                        if (user == NULL || !pwq->gecos_check)
+                                continue;
+                        break;
+                case PWQ_RULE_NAMES:
+                        if (pwq->name_index == NULL)
+                                continue;
+                        break;
+                case PWQ_RULE_DICT:
+#ifdef HAVE_CRACK_H
+                        if (!pwq->dict_check)
+                                continue;
+                        break;
+#else
+                        continue;
+#endif
+                }
+                run |= 1U << rule;
+                if (rule == failed)
+                        break;
+        }
+
+        return run;
+}
+
+/* fill in the features of the inputs and append the record to the
+ * capture file, failures are ignored so the check is not affected */
+void
+capture_finish(pwquality_settings_t *pwq, struct pwq_capture_record *rec,
+        uint64_t start, int result, const char *password,
+        const char *oldpassword, const char *user)
+{
+        const char *p;
+        int fd;
+
+        rec->check_ns = capture_elapsed(start);
+        rec->result = result;
+
+        if (password) {
+                size_t digits = 0, uppers = 0, lowers = 0, others = 0;
+
+                for (p = password; *p != '\0'; p++) {
+                        if (isdigit((unsigned char)*p))
+                                digits++;
+                        else if (isupper((unsigned char)*p))
+                                uppers++;
+                        else if (islower((unsigned char)*p))
+                                lowers++;
+                        else
+                                others++;
+                }
+                rec->length = clamp16(p - password);
+                rec->digits = clamp16(digits);
+                rec->uppers = clamp16(uppers);
+                rec->lowers = clamp16(lowers);
+                rec->others = clamp16(others);
+        }
+
+        if (oldpassword && *oldpassword == '\0')
+                oldpassword = NULL;
+        if (user && *user == '\0')
+                user = NULL;
+
+        if (oldpassword)
+                rec->old_length = clamp16(strlen(oldpassword));
+        if (user)
+                rec->user_length = clamp16(strlen(user));
+
+        rec->failed_rule = failed_rule(result);
+        rec->rules_run = rules_run(pwq, rec->failed_rule, result,
+                oldpassword, user);
+
+        fd = __atomic_load_n(&pwq->capture_fd, __ATOMIC_ACQUIRE);
+        if (fd == -1) {
+                int expected = -1;
+
+                fd = open(pwq->capture_file,
+                        O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC|O_NOFOLLOW, 0600);
+                if (fd == -1)
+                        return;
+                /* another thread could have opened it meanwhile */
+                if (!__atomic_compare_exchange_n(&pwq->capture_fd, &expected,
+                        fd, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                        (void)close(fd);
+                        fd = expected;
+                }
+        }
+
+        /* a single small write with O_APPEND keeps the records of
+         * concurrent processes whole */
+        (void)write(fd, rec, sizeof(*rec));
+}
+
+void
+capture_close(pwquality_settings_t *pwq)
+{
+        if (pwq->capture_fd != -1) {
+                (void)close(pwq->capture_fd);
+                pwq->capture_fd = -1;
+        }
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
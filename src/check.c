@@ -15,6 +15,7 @@
 #include <sys/types.h>
 #include <pwd.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "pwquality.h"
 #include "pwqprivate.h"
@@ -24,6 +25,12 @@
 #endif
 #define MIN(_a, _b) (((_a) < (_b)) ? (_a) : (_b))
 
+#ifdef HAVE_CRACK_H
+/* FascistCheck() is not reentrant, the checks can run in the
+ * threads of the asynchronous API */
+pthread_mutex_t cracklib_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /* Helper functions */
 
 /*
@@ -47,89 +54,61 @@ palindrome(const char *new)
  * Calculate how different two strings are in terms of the number of
  * character removals, additions, and changes needed to go from one to
  * the other
+ *
+ * Each cell is the minimum of its three neighbours plus one if the
+ * characters differ, so only the previous row needs to be kept.
+ * The minimum of a row never decreases with the following rows, so
+ * once it reaches the limit the distance cannot be lower than that
+ * and the calculation stops. The callers only compare the result
+ * with the limit, below the limit it is the same as of the recursive
+ * variant in check_ref.c.
  */
 
-static int 
-distdifferent(const char *old, const char *new,
-              size_t i, size_t j)
-{
-        char c, d;
-
-        if ((i == 0) || (strlen(old) < i)) {
-                c = 0;
-        } else {
-                c = old[i - 1];
-        }
-
-        if ((j == 0) || (strlen(new) < j)) {
-                d = 0;
-        } else {
-                d = new[j - 1];
-        }
-        return (c != d);
-}
-
-static int
-distcalculate(int **distances, const char *old, const char *new,
-              size_t i, size_t j)
-{
-        int tmp = 0;
-
-        if (distances[i][j] != -1) {
-                return distances[i][j];
-        }
-
-        tmp = distcalculate(distances, old, new, i - 1, j - 1);
-        tmp = MIN(tmp, distcalculate(distances, old, new, i, j - 1));
-        tmp = MIN(tmp, distcalculate(distances, old, new, i - 1,     j));
-        tmp += distdifferent(old, new, i, j);
-
-        distances[i][j] = tmp;
-
-        return tmp;
-}
+#define STACK_BUF_LEN 64 /* strings up to this length need no allocation */
 
 static int
-distance(const char *old, const char *new)
+distance(const char *old, const char *new, int limit)
 {
-        int **distances = NULL;
+        int stackrows[2 * (STACK_BUF_LEN + 1)];
+        int *prev, *cur, *tmp, *rows = stackrows;
         size_t m, n, i, j;
-        int r = -1;
+        int rowmin, r;
 
         m = strlen(old);
         n = strlen(new);
-        distances = calloc(m + 1, sizeof(int*));
-        if (distances == NULL)
-                return -1;
-
-        for (i = 0; i <= m; i++) {
-                distances[i] = calloc(n + 1, sizeof(int));
-                if (distances[i] == NULL)
-                        goto allocfail;
-
-                for(j = 0; j <= n; j++) {
-                        distances[i][j] = -1;
-                }
+        if (n > STACK_BUF_LEN) {
+                rows = malloc(2 * (n + 1) * sizeof(int));
+                if (rows == NULL)
+                        return -1;
         }
+        prev = rows;
+        cur = rows + n + 1;
 
-        for (i = 0; i <= m; i++) {
-                distances[i][0] = i;
-        }
+        for (j = 0; j <= n; j++)
+                prev[j] = j;
+        rowmin = 0;
 
-        for (j = 0; j <= n; j++) {
-                distances[0][j] = j;
-        }
+        for (i = 1; i <= m && rowmin < limit; i++) {
+                char c = old[i - 1];
 
-        r = distcalculate(distances, old, new, m, n);
+                cur[0] = rowmin = i;
+                for (j = 1; j <= n; j++) {
+                        int d = MIN(prev[j - 1], cur[j - 1]);
 
-allocfail:
-        for (i = 0; i <= m; i++) {
-                if (distances[i]) {
-                        memset(distances[i], 0, sizeof(int) * (n + 1));
-                        free(distances[i]);
+                        d = MIN(d, prev[j]);
+                        cur[j] = d + (c != new[j - 1]);
+                        rowmin = MIN(rowmin, cur[j]);
                 }
+                tmp = prev;
+                prev = cur;
+                cur = tmp;
         }
-        free(distances);
+
+        r = i > m ? prev[n] : rowmin;
+
+        memset(rows, 0, 2 * (n + 1) * sizeof(int));
+        if (rows != stackrows)
+                free(rows);
 
         return r;
 }
@@ -138,14 +117,15 @@ static int
 similar(pwquality_settings_t *pwq,
         const char *old, const char *new)
 {
+        const int diff_ok = PWQ_CHECK_SETTING(pwq, diff_ok);
         int dist;
 
-        dist = distance(old, new);
+        dist = distance(old, new, diff_ok);
 
         if (dist < 0)
                 return PWQ_ERROR_MEM_ALLOC;
 
-        if (dist >= pwq->diff_ok) {
+        if (dist >= diff_ok) {
                 return 0;
         }
 
@@ -157,6 +137,98 @@ similar(pwquality_settings_t *pwq,
         return PWQ_ERROR_TOO_SIMILAR;
 }
 
+/*
+ * Check whether the passwords share a substring of old_substr characters.
+ * Any longer common substring contains one of exactly that length, so
+ * the windows of that length of the old password are put into a hash
+ * table by a rolling hash and the windows of the new password are looked
+ * up in it. The windows with equal hashes are compared so the result is
+ * exact. It takes O(n + m) time for passwords of length n and m.
+ */
+
+#define SUBSTR_HASH_BASE 0x100000001b3ULL
+#define SUBSTR_HASH_MIX  0x9e3779b97f4a7c15ULL
+
+static int
+oldsubstr(pwquality_settings_t *pwq, const char *old, const char *new,
+          void **auxerror)
+{
+        const int old_substr = PWQ_CHECK_SETTING(pwq, old_substr);
+        uint64_t stackhashes[2 * STACK_BUF_LEN];
+        size_t stackpos[2 * STACK_BUF_LEN];
+        uint64_t *hashes = stackhashes;
+        size_t *pos = stackpos;
+        size_t m, n, k, i, slot, mask;
+        uint64_t power = 1, h;
+        int bits, rv = 0;
+
+        m = strlen(old);
+        n = strlen(new);
+        k = old_substr;
+        if (old_substr <= 0 || k > m || k > n)
+                return 0;
+
+        /* keep the table at most half full */
+        for (bits = 1; ((size_t)1 << bits) < 2 * (m - k + 1); bits++)
+                ;
+        if (((size_t)1 << bits) > 2 * STACK_BUF_LEN) {
+                hashes = malloc(sizeof(*hashes) << bits);
+                pos = malloc(sizeof(*pos) << bits);
+                if (hashes == NULL || pos == NULL) {
+                        free(hashes);
+                        free(pos);
+                        return PWQ_ERROR_MEM_ALLOC;
+                }
+        }
+        mask = ((size_t)1 << bits) - 1;
+        /* position + 1 of the window, 0 is an empty slot */
+        memset(pos, 0, sizeof(*pos) << bits);
+
+        for (i = 1; i < k; i++)
+                power *= SUBSTR_HASH_BASE;
+
+        h = 0;
+        for (i = 0; i < m; i++) {
+                if (i >= k)
+                        h -= power * (unsigned char)old[i - k];
+                h = h * SUBSTR_HASH_BASE + (unsigned char)old[i];
+                if (i + 1 < k)
+                        continue;
+                slot = (h * SUBSTR_HASH_MIX) >> (64 - bits);
+                while (pos[slot])
+                        slot = (slot + 1) & mask;
+                hashes[slot] = h;
+                pos[slot] = i + 2 - k;
+        }
+
+        h = 0;
+        for (i = 0; i < n && !rv; i++) {
+                if (i >= k)
+                        h -= power * (unsigned char)new[i - k];
+                h = h * SUBSTR_HASH_BASE + (unsigned char)new[i];
+                if (i + 1 < k)
+                        continue;
+                for (slot = (h * SUBSTR_HASH_MIX) >> (64 - bits); pos[slot];
+                     slot = (slot + 1) & mask) {
+                        if (hashes[slot] == h &&
+                            memcmp(old + pos[slot] - 1, new + i + 1 - k, k) == 0) {
+                                if (auxerror)
+                                        *auxerror = (void *)(long)old_substr;
+                                rv = PWQ_ERROR_OLD_SUBSTR;
+                                break;
+                        }
+                }
+        }
+
+        memset(hashes, 0, sizeof(*hashes) << bits);
+        if (hashes != stackhashes) {
+                free(hashes);
+                free(pos);
+        }
+
+        return rv;
+}
+
 /*
  * count classes of charecters
  */
@@ -196,6 +268,12 @@ numclass(const char *new)
 static int
 simple(pwquality_settings_t *pwq, const char *new, void **auxerror)
 {
+        const int dig_credit = PWQ_CHECK_SETTING(pwq, dig_credit);
+        const int up_credit = PWQ_CHECK_SETTING(pwq, up_credit);
+        const int low_credit = PWQ_CHECK_SETTING(pwq, low_credit);
+        const int oth_credit = PWQ_CHECK_SETTING(pwq, oth_credit);
+        const int min_length = PWQ_CHECK_SETTING(pwq, min_length);
+        const int max_class_repeat = PWQ_CHECK_SETTING(pwq, max_class_repeat);
         int digits = 0;
         int uppers = 0;
         int lowers = 0;
@@ -238,56 +316,56 @@ simple(pwquality_settings_t *pwq, const char *new, void **auxerror)
                         } else
                                 sameclass++;
                 }
-                if (pwq->max_class_repeat > 0 && sameclass > pwq->max_class_repeat) {
+                if (max_class_repeat > 0 && sameclass > max_class_repeat) {
                         if (auxerror)
-                                *auxerror = (void *)(long)pwq->max_class_repeat;
+                                *auxerror = (void *)(long)max_class_repeat;
                         return PWQ_ERROR_MAX_CLASS_REPEAT;
                 }
         }
 
-        if ((pwq->dig_credit >= 0) && (digits > pwq->dig_credit))
-                digits = pwq->dig_credit;
+        if ((dig_credit >= 0) && (digits > dig_credit))
+                digits = dig_credit;
 
-        if ((pwq->up_credit >= 0) && (uppers > pwq->up_credit))
-                uppers = pwq->up_credit;
+        if ((up_credit >= 0) && (uppers > up_credit))
+                uppers = up_credit;
 
-        if ((pwq->low_credit >= 0) && (lowers > pwq->low_credit))
-                lowers = pwq->low_credit;
+        if ((low_credit >= 0) && (lowers > low_credit))
+                lowers = low_credit;
 
-        if ((pwq->oth_credit >= 0) && (others > pwq->oth_credit))
-                others = pwq->oth_credit;
+        if ((oth_credit >= 0) && (others > oth_credit))
+                others = oth_credit;
 
-        size = pwq->min_length;
+        size = min_length;
 
-        if (pwq->dig_credit >= 0)
+        if (dig_credit >= 0)
                 size -= digits;
-        else if (digits < -pwq->dig_credit) {
+        else if (digits < -dig_credit) {
                 if (auxerror)
-                        *auxerror = (void *)(long)-pwq->dig_credit;
+                        *auxerror = (void *)(long)-dig_credit;
                 return PWQ_ERROR_MIN_DIGITS;
         }
 
-        if (pwq->up_credit >= 0)
+        if (up_credit >= 0)
                 size -= uppers;
-        else if (uppers < -pwq->up_credit) {
+        else if (uppers < -up_credit) {
                 if (auxerror)
-                        *auxerror = (void *)(long)-pwq->up_credit;
+                        *auxerror = (void *)(long)-up_credit;
                 return PWQ_ERROR_MIN_UPPERS;
         }
 
-        if (pwq->low_credit >= 0)
+        if (low_credit >= 0)
                 size -= lowers;
-        else if (lowers < -pwq->low_credit) {
+        else if (lowers < -low_credit) {
                 if (auxerror)
-                        *auxerror = (void *)(long)-pwq->low_credit;
+                        *auxerror = (void *)(long)-low_credit;
                 return PWQ_ERROR_MIN_LOWERS;
         }
 
-        if (pwq->oth_credit >= 0)
+        if (oth_credit >= 0)
                 size -= others;
-        else if (others < -pwq->oth_credit) {
+        else if (others < -oth_credit) {
                 if (auxerror)
-                        *auxerror = (void *)(long)-pwq->oth_credit;
+                        *auxerror = (void *)(long)-oth_credit;
                 return PWQ_ERROR_MIN_OTHERS;
         }
 
@@ -307,19 +385,20 @@ simple(pwquality_settings_t *pwq, const char *new, void **auxerror)
 static int
 consecutive(pwquality_settings_t *pwq, const char *new, void **auxerror)
 {
+        const int max_repeat = PWQ_CHECK_SETTING(pwq, max_repeat);
         char c = new[0];
         int i;
         int same = 1;
 
-        if (pwq->max_repeat == 0 || c == '\0')
+        if (max_repeat == 0 || c == '\0')
                 return 0;
 
         for (i = 1; new[i]; i++) {
                 if (new[i] == c) {
                         ++same;
-                        if (same > pwq->max_repeat) {
+                        if (same > max_repeat) {
                                 if (auxerror)
-                                        *auxerror = (void *)(long)pwq->max_repeat;
+                                        *auxerror = (void *)(long)max_repeat;
                                 return 1;
                         }
                 } else {
@@ -332,12 +411,13 @@ consecutive(pwquality_settings_t *pwq, const char *new, void **auxerror)
 
 static int sequence(pwquality_settings_t *pwq, const char *new, void **auxerror)
 {
+        const int max_sequence = PWQ_CHECK_SETTING(pwq, max_sequence);
         char c;
         int i;
         int sequp = 1;
         int seqdown = 1;
 
-        if (pwq->max_sequence == 0)
+        if (max_sequence == 0)
                 return 0;
 
         if (new[0] == '\0')
@@ -347,17 +427,17 @@ static int sequence(pwquality_settings_t *pwq, const char *new, void **auxerror)
                 c = new[i-1];
                 if (new[i] == c+1) {
                         ++sequp;
-                        if (sequp > pwq->max_sequence) {
+                        if (sequp > max_sequence) {
                                 if (auxerror)
-                                        *auxerror = (void *)(long)pwq->max_sequence;
+                                        *auxerror = (void *)(long)max_sequence;
                                 return 1;
                         }
                         seqdown = 1;
                 } else if (new[i] == c-1) {
                         ++seqdown;
-                        if (seqdown > pwq->max_sequence) {
+                        if (seqdown > max_sequence) {
                                 if (auxerror)
-                                        *auxerror = (void *)(long)pwq->max_sequence;
+                                        *auxerror = (void *)(long)max_sequence;
                                 return 1;
                         }
                         sequp = 1;
@@ -384,7 +464,7 @@ wordcheck(pwquality_settings_t *pwq, const char *new,
         if (strstr(new, word) != NULL)
                 return PWQ_ERROR_BAD_WORDS;
 
-        dist = distance(new, word);
+        dist = distance(new, word, PWQ_DEFAULT_DIFF_OK);
         if (dist >= 0 && dist < PWQ_DEFAULT_DIFF_OK)
                 return PWQ_ERROR_BAD_WORDS;
 
@@ -405,7 +485,7 @@ wordcheck(pwquality_settings_t *pwq, const char *new,
         if (strstr(new, word) != NULL)
                 return PWQ_ERROR_BAD_WORDS;
 
-        dist = distance(new, word);
+        dist = distance(new, word, PWQ_DEFAULT_DIFF_OK);
         if (dist >= 0 && dist < PWQ_DEFAULT_DIFF_OK)
                 return PWQ_ERROR_BAD_WORDS;
 
@@ -416,20 +496,21 @@ static int
 usercheck(pwquality_settings_t *pwq, const char *new,
           char *user)
 {
+        const int user_substr = PWQ_CHECK_SETTING(pwq, user_substr);
         int i, userlen;
         int rv = 0;
-        char *subuser = calloc(pwq->user_substr+1, sizeof(char));
+        char *subuser = calloc(user_substr+1, sizeof(char));
 
         if (subuser == NULL) {
                 return PWQ_ERROR_MEM_ALLOC;
         }
 
         userlen = strlen(user);
-        if (pwq->user_substr >= PWQ_MIN_WORD_LENGTH &&
-            userlen > pwq->user_substr) {
-                for(i = 0; !rv && (i <= userlen - pwq->user_substr); i++) {
-                        strncpy(subuser, user+i, pwq->user_substr+1);
-                        subuser[pwq->user_substr] = '\0';
+        if (user_substr >= PWQ_MIN_WORD_LENGTH &&
+            userlen > user_substr) {
+                for(i = 0; !rv && (i <= userlen - user_substr); i++) {
+                        strncpy(subuser, user+i, user_substr+1);
+                        subuser[user_substr] = '\0';
                         rv = wordcheck(pwq, new, subuser);
                 }
         }
@@ -497,14 +578,30 @@ wordlistcheck(pwquality_settings_t *pwq, const char *new,
 
 static int
 gecoscheck(pwquality_settings_t *pwq, const char *new,
-           const char *user)
+           const char *user, struct pwq_users *users,
+           struct pwq_capture_record *rec)
 {
         struct passwd pwd;
         struct passwd *result;
+        const char *words;
+        size_t gecoslen;
         char *buf;
         long bufsize;
+        uint64_t start = 0;
         int rv;
 
+        /* the users prefetched for a batch need no lookup */
+        if (users && users_lookup(users, user, &words, &gecoslen)) {
+                if (rec) {
+                        rec->flags |= PWQ_CAPTURE_USER_FOUND;
+                        rec->gecos_length = gecoslen;
+                }
+                rv = wordlistcheck(pwq, new, words);
+                if (rv == PWQ_ERROR_BAD_WORDS)
+                        rv = PWQ_ERROR_GECOS_CHECK;
+                return rv;
+        }
+
         bufsize = sysconf(_SC_GETPW_R_SIZE_MAX);
         if (bufsize == -1 || bufsize > PWQ_MAX_PASSWD_BUF_LEN)
                 bufsize = PWQ_MAX_PASSWD_BUF_LEN;
@@ -512,8 +609,22 @@ gecoscheck(pwquality_settings_t *pwq, const char *new,
         if (buf == NULL)
                 return PWQ_ERROR_MEM_ALLOC;
 
-        if (getpwnam_r(user, &pwd, buf, bufsize, &result) != 0 ||
-                result == NULL) {
+        if (rec)
+                start = capture_clock();
+
+        if (getpwnam_r(user, &pwd, buf, bufsize, &result) != 0)
+                result = NULL;
+
+        if (rec) {
+                rec->gecos_ns = capture_elapsed(start);
+                if (result) {
+                        rec->flags |= PWQ_CAPTURE_USER_FOUND;
+                        if (result->pw_gecos)
+                                rec->gecos_length = strlen(result->pw_gecos);
+                }
+        }
+
+        if (result == NULL) {
                 free(buf);
                 return 0;
         }
@@ -537,7 +648,8 @@ x_strdup(const char *string)
 static int
 password_check(pwquality_settings_t *pwq,
                const char *new, const char *old, const char *user,
-               void **auxerror)
+               struct pwq_users *users, void **auxerror,
+               struct pwq_capture_record *rec)
 {
         int rv = 0;
         char *oldmono = NULL, *newmono, *wrapped = NULL;
@@ -547,7 +659,7 @@ password_check(pwquality_settings_t *pwq,
         if (!newmono)
                 rv = PWQ_ERROR_MEM_ALLOC;
 
-        if (!rv && user) {
+        if (!rv && user && PWQ_CHECK_SETTING(pwq, user_check)) {
                 usermono = str_lower(x_strdup(user));
                 if (!usermono)
                         rv = PWQ_ERROR_MEM_ALLOC;
@@ -571,16 +683,20 @@ password_check(pwquality_settings_t *pwq,
         if (!rv && oldmono)
                 rv = similar(pwq, oldmono, newmono);
 
+        if (!rv && oldmono &&
+            PWQ_CHECK_SETTING(pwq, old_substr) >= PWQ_MIN_WORD_LENGTH)
+                rv = oldsubstr(pwq, oldmono, newmono, auxerror);
+
         if (!rv)
                 rv = simple(pwq, new, auxerror);
 
         if (!rv && wrapped && strstr(wrapped, newmono))
                 rv = PWQ_ERROR_ROTATED;
 
-        if (!rv && numclass(new) < pwq->min_class) {
+        if (!rv && numclass(new) < PWQ_CHECK_SETTING(pwq, min_class)) {
                 rv = PWQ_ERROR_MIN_CLASSES;
                 if (auxerror) {
-                        *auxerror = (void *)(long)pwq->min_class;
+                        *auxerror = (void *)(long)PWQ_CHECK_SETTING(pwq, min_class);
                 }
         }
 
@@ -593,14 +709,17 @@ password_check(pwquality_settings_t *pwq,
         if (!rv && sequence(pwq, new, auxerror))
                 rv = PWQ_ERROR_MAX_SEQUENCE;
 
-        if (!rv && usermono && pwq->user_check)
+        if (!rv && usermono && PWQ_CHECK_SETTING(pwq, user_check))
                 rv = usercheck(pwq, newmono, usermono);
 
-        if (!rv && user && pwq->gecos_check)
-                rv = gecoscheck(pwq, newmono, user);
+        if (!rv && user && PWQ_CHECK_SETTING(pwq, gecos_check))
+                rv = gecoscheck(pwq, newmono, user, users, rec);
+
+        if (!rv && pwq->name_index)
+                rv = names_check(pwq, newmono);
 
         if (!rv)
-                rv = wordlistcheck(pwq, newmono, pwq->bad_words);
+                rv = wordlistcheck(pwq, newmono, PWQ_CHECK_SETTING(pwq, bad_words));
 
         if (newmono) {
                 memset(newmono, 0, strlen(newmono));
@@ -631,15 +750,17 @@ password_score(pwquality_settings_t *pwq, const char *password)
         int i;
         int j;
         unsigned char freq[256];
-        unsigned char *buf;
+        unsigned char stackbuf[STACK_BUF_LEN];
+        unsigned char *buf = stackbuf;
+        const int min_length = PWQ_CHECK_SETTING(pwq, min_length);
 
         len = strlen(password);
 
-        if ((buf = malloc(len)) == NULL)
+        if (len > STACK_BUF_LEN && (buf = malloc(len)) == NULL)
                 /* should get enough memory to obtain a nice score */
                 return PWQ_ERROR_MEM_ALLOC;
 
-        score = (len - pwq->min_length) * 2;
+        score = (len - min_length) * 2;
 
         memcpy(buf, password, len);
 
@@ -660,11 +781,12 @@ password_score(pwquality_settings_t *pwq, const char *password)
         }
 
         memset(buf, 0, len);
-        free(buf);
+        if (buf != stackbuf)
+                free(buf);
 
         score += numclass(password) * 2;
 
-        score = (score * 100)/(3 * pwq->min_length +
+        score = (score * 100)/(3 * min_length +
                                + PWQ_NUM_CLASSES * 2);
 
         score -= 50;
@@ -677,12 +799,10 @@ password_score(pwquality_settings_t *pwq, const char *password)
         return score;
 }
 
-/* check the password according to the settings
- * it returns either score <0-100> or negative error number;
- * the old password is optional */
-int
-pwquality_check(pwquality_settings_t *pwq, const char *password,
-        const char *oldpassword, const char *user, void **auxerror)
+static int
+check(pwquality_settings_t *pwq, const char *password,
+        const char *oldpassword, const char *user, struct pwq_users *users,
+        void **auxerror, struct pwq_capture_record *rec)
 {
         const char *msg;
         int score;
@@ -704,17 +824,31 @@ pwquality_check(pwquality_settings_t *pwq, const char *password,
                 return PWQ_ERROR_SAME_PASSWORD;
         }
 
-        if (pwq->diff_ok == 0)
+        if (PWQ_CHECK_SETTING(pwq, diff_ok) == 0)
                 oldpassword = NULL;
 
-        score = password_check(pwq, password, oldpassword, user, auxerror);
+        score = password_check(pwq, password, oldpassword, user, users,
+                auxerror, rec);
 
         if (score != 0)
                 return score;
 
         #ifdef HAVE_CRACK_H
-        if (pwq->dict_check) {
+        if (PWQ_CHECK_SETTING(pwq, dict_check)) {
+                uint64_t start = 0;
+
+                /* only the first check of the settings object pays for it
+                   unless the preloading fails */
+                if (pwq->dict_preload)
+                        dict_preload_once(pwq);
+
+                if (rec)
+                        start = capture_clock();
+                pthread_mutex_lock(&cracklib_lock);
                 msg = FascistCheck(password, pwq->dict_path);
+                pthread_mutex_unlock(&cracklib_lock);
+                if (rec)
+                        rec->dict_ns = capture_elapsed(start);
                 if (msg) {
                         if (auxerror)
                                 *auxerror = (void *)msg;
@@ -728,6 +862,39 @@ pwquality_check(pwquality_settings_t *pwq, const char *password,
         return score;
 }
 
+/* check the password with the GECOS fields of the users looked up
+ * in the prefetched map first */
+int
+check_with_users(pwquality_settings_t *pwq, const char *password,
+        const char *oldpassword, const char *user, struct pwq_users *users,
+        void **auxerror)
+{
+        struct pwq_capture_record rec;
+        uint64_t start;
+        int rv;
+
+        if (pwq->capture_file == NULL)
+                return check(pwq, password, oldpassword, user, users,
+                        auxerror, NULL);
+
+        start = capture_start(&rec);
+        rv = check(pwq, password, oldpassword, user, users, auxerror, &rec);
+        capture_finish(pwq, &rec, start, rv, password, oldpassword, user);
+
+        return rv;
+}
+
+/* check the password according to the settings
+ * it returns either score <0-100> or negative error number;
+ * the old password is optional */
+int
+pwquality_check(pwquality_settings_t *pwq, const char *password,
+        const char *oldpassword, const char *user, void **auxerror)
+{
+        return check_with_users(pwq, password, oldpassword, user, NULL,
+                auxerror);
+}
+
 /*
  * Copyright (c) Cristian Gafton <gafton@redhat.com>, 1996.
  *                                              All rights reserved
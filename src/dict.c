@@ -0,0 +1,226 @@
+/*
+ * libpwquality API code for keeping the dictionary in memory
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef HAVE_CRACK_H
+#include <crack.h>
+#endif
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+static const char *dict_suffixes[PWQ_DICT_FILES] = PWQ_DICT_SUFFIXES;
+
+/* cracklib decompresses the .pwd.gz file on every open, so there is
+ * nothing to read ahead or lock for a compressed dictionary */
+static int
+dict_compressed(const char *path)
+{
+        char *fname;
+        int rv;
+
+        if (asprintf(&fname, "%s%s.gz", path, dict_suffixes[0]) < 0)
+                return 0;
+        rv = access(fname, F_OK) == 0;
+        free(fname);
+        return rv;
+}
+
+/* the dictionary used by the check, NULL if there is none */
+const char *
+dict_path(pwquality_settings_t *pwq)
+{
+#ifdef HAVE_CRACK_H
+        if (pwq->dict_path == NULL)
+                return GetDefaultCracklibDict();
+#endif
+        return pwq->dict_path;
+}
+
+/* map the file and touch every page so it is read in sequentially
+ * instead of page by page with random access later */
+static int
+dict_fault(const char *path, int lock, struct pwq_dict_map *map)
+{
+        struct stat st;
+        long pagesize = sysconf(_SC_PAGESIZE);
+        volatile const char *p;
+        void *addr;
+        size_t off;
+        int fd;
+
+        fd = open(path, O_RDONLY|O_CLOEXEC);
+        if (fd == -1)
+                return -1;
+
+        if (fstat(fd, &st) == -1) {
+                (void)close(fd);
+                return -1;
+        }
+        if (st.st_size == 0) {
+                (void)close(fd);
+                return 0;
+        }
+
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        (void)close(fd);
+        if (addr == MAP_FAILED)
+                return -1;
+
+        (void)madvise(addr, st.st_size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        if (lock)
+                (void)madvise(addr, st.st_size, MADV_HUGEPAGE);
+#endif
+
+        for (p = addr, off = 0; off < (size_t)st.st_size; off += pagesize)
+                (void)p[off];
+
+        if (!lock) {
+                munmap(addr, st.st_size);
+                return 0;
+        }
+
+        if (mlock(addr, st.st_size) == -1) {
+                munmap(addr, st.st_size);
+                return -1;
+        }
+
+        map->addr = addr;
+        map->len = st.st_size;
+        return 0;
+}
+
+/* read the dictionary into memory */
+int
+pwquality_preload_dict(pwquality_settings_t *pwq)
+{
+        const char *path = dict_path(pwq);
+        int lock = pwq->dict_preload >= PWQ_DICT_PRELOAD_LOCK;
+        int i;
+
+        if (path == NULL)
+                return 0;
+
+        for (i = 0; i < PWQ_DICT_FILES; i++) {
+                char *fname;
+                int rv;
+
+                if (pwq->dict->maps[i].addr)
+                        continue;
+
+                if (asprintf(&fname, "%s%s", path, dict_suffixes[i]) < 0)
+                        return PWQ_ERROR_MEM_ALLOC;
+
+                rv = dict_fault(fname, lock, &pwq->dict->maps[i]);
+                free(fname);
+                if (rv < 0 && errno == ENOENT && i == 0 && dict_compressed(path))
+                        return 0;
+                /* the .hwm file is optional */
+                if (rv < 0 && !(errno == ENOENT && i == PWQ_DICT_FILES - 1))
+                        return PWQ_ERROR_DICT_PRELOAD;
+        }
+
+        return 0;
+}
+
+/* preload the dictionary for the check, only one of the concurrent checks
+ * with the settings or their copies does it and the others go on without
+ * waiting */
+void
+dict_preload_once(pwquality_settings_t *pwq)
+{
+        struct pwq_dict_state *dict = pwq->dict;
+        int state = PWQ_DICT_PRELOADED_NO;
+
+        if (!__atomic_compare_exchange_n(&dict->preloaded, &state,
+                PWQ_DICT_PRELOADED_BUSY, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                return;
+
+        if (pwquality_preload_dict(pwq) == 0 ||
+            ++dict->preload_failures >= PWQ_DICT_PRELOAD_TRIES)
+                state = PWQ_DICT_PRELOADED_YES;
+        __atomic_store_n(&dict->preloaded, state, __ATOMIC_RELEASE);
+}
+
+/* release the locked dictionary with the last reference to it */
+void
+dict_unload(pwquality_settings_t *pwq)
+{
+        struct pwq_dict_state *dict = pwq->dict;
+        int i;
+
+        pwq->dict = NULL;
+        if (dict == NULL || __atomic_sub_fetch(&dict->refs, 1, __ATOMIC_ACQ_REL) > 0)
+                return;
+
+        for (i = 0; i < PWQ_DICT_FILES; i++) {
+                if (dict->maps[i].addr) {
+                        munlock(dict->maps[i].addr, dict->maps[i].len);
+                        munmap(dict->maps[i].addr, dict->maps[i].len);
+                }
+        }
+        free(dict);
+}
+
+/* start over with nothing preloaded after the dictionary or the
+ * preloading changed, the copies of the settings keep the old state */
+int
+dict_reset(pwquality_settings_t *pwq)
+{
+        struct pwq_dict_state *dict;
+
+        if ((dict = calloc(1, sizeof(*dict))) == NULL)
+                return PWQ_ERROR_MEM_ALLOC;
+        dict->refs = 1;
+        dict_unload(pwq);
+        pwq->dict = dict;
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
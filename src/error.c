@@ -45,6 +45,8 @@ pwquality_strerror(char *buf, size_t len, int rv, void *auxerror)
                 return _("The password contains the user name in some form");
         case PWQ_ERROR_GECOS_CHECK:
                 return _("The password contains words from the real name of the user in some form");
+        case PWQ_ERROR_NAMES:
+                return _("The password contains a known name in some form");
         case PWQ_ERROR_BAD_WORDS:
                 return _("The password contains forbidden words in some form");
         case PWQ_ERROR_MIN_DIGITS:
@@ -103,12 +105,26 @@ pwquality_strerror(char *buf, size_t len, int rv, void *auxerror)
                         return buf;
                 }
                 return _("The password contains too long of a monotonic character sequence");
+        case PWQ_ERROR_OLD_SUBSTR:
+                if (auxerror) {
+                        snprintf(buf, len, _("The password contains %ld or more consecutive characters of the old password"), (long)auxerror);
+                        return buf;
+                }
+                return _("The password contains too long part of the old password");
         case PWQ_ERROR_EMPTY_PASSWORD:
                 return _("No password supplied");
         case PWQ_ERROR_RNG:
                 return _("Cannot obtain random numbers from the RNG device");
         case PWQ_ERROR_GENERATION_FAILED:
                 return _("Password generation failed - required entropy too low for settings");
+        case PWQ_ERROR_GEN_MODEL:
+                return _("The password generation model is missing or corrupted");
+        case PWQ_ERROR_DICT_PRELOAD:
+                return _("Cannot load the dictionary into memory");
+        case PWQ_ERROR_USERS_PREFETCH:
+                return _("Cannot read the user database");
+        case PWQ_ERROR_NAME_INDEX:
+                return _("The name index is missing or corrupted");
         case PWQ_ERROR_CRACKLIB_CHECK:
                 if (auxerror) {
                         snprintf(buf, len, "%s - %s", _("The password fails the dictionary check"), (const char *)auxerror);
@@ -16,6 +16,8 @@
 #include <fcntl.h>
 #include <ctype.h>
 #include <limits.h>
+#include <math.h>
+#include <sys/mman.h>
 #ifdef HAVE_CRACK_H
 #include <crack.h>
 #endif
@@ -41,8 +43,16 @@ static char consonants2[] = { 'b', 'c', 'd', 'f', 'g', 'h', 'j', 'k', 'l', 'm',
         '1', '2', '5', '6', '7', '8', '9', '!', '#', '$',
         '%', '^', '&', '*', '(', ')', '-', '+', '=', '[',
         ']', ';', '.', ',' }; /* 6 bits */
+static char separators[] = { '2', '3', '4', '5', '6', '7', '8', '9',
+        '!', '#', '%', '+', '-', '=', '@', '.' }; /* 4 bits */
 
-static int
+/* fixed point unit of the entropy accounting in the model generator */
+#define MODEL_ENTROPY_ONE 65536
+/* enough random bytes for a password of PWQ_MAX_ENTROPY_BITS drawn from
+ * a model with about 1.5 bits per character in a single read */
+#define MODEL_POOL_LEN    1024
+
+int
 get_entropy_bits(char *buf, int nbits)
 {
         int fd;
@@ -98,11 +108,174 @@ consume_entropy(char *buf, int bits, int *remaining, int *offset)
         return low;    
 }
 
+/* consume more than 8 bits at once, refilling the entropy buffer if needed */
+static int
+consume_entropy_long(char *buf, int buflen, int bits, int *offset,
+                     unsigned int *value)
+{
+        int shift = 0;
+
+        if (*offset + bits > buflen * 8) {
+                if (get_entropy_bits(buf, buflen * 8) < 0)
+                        return -1;
+                *offset = 0;
+        }
+
+        *value = 0;
+        while (bits > 0) {
+                int chunk = bits > 8 ? 8 : bits;
+
+                *value |= consume_entropy(buf, chunk, NULL, offset) << shift;
+                shift += chunk;
+                bits -= chunk;
+        }
+        return 0;
+}
+
+/* map the model file, the states are validated lazily when first visited */
+static const struct pwq_model_state *
+load_model(const char *path, void **map, size_t *maplen)
+{
+        const struct pwq_model_header *hdr;
+        struct stat st;
+        int fd;
+
+        fd = open(path, O_RDONLY|O_CLOEXEC);
+        if (fd == -1)
+                return NULL;
+
+        if (fstat(fd, &st) == -1 || (size_t)st.st_size != sizeof(*hdr) +
+            PWQ_MODEL_STATES * sizeof(struct pwq_model_state)) {
+                (void)close(fd);
+                return NULL;
+        }
+
+        *maplen = st.st_size;
+        *map = mmap(NULL, *maplen, PROT_READ, MAP_PRIVATE, fd, 0);
+        (void)close(fd);
+        if (*map == MAP_FAILED)
+                return NULL;
+
+        hdr = *map;
+        if (memcmp(hdr->magic, PWQ_MODEL_MAGIC, sizeof(hdr->magic)) != 0 ||
+            hdr->version != PWQ_MODEL_VERSION ||
+            hdr->columns != PWQ_MODEL_COLUMNS ||
+            hdr->states != PWQ_MODEL_STATES ||
+            hdr->endian != PWQ_MODEL_ENDIAN) {
+                munmap(*map, *maplen);
+                return NULL;
+        }
+
+        return (const struct pwq_model_state *)(hdr + 1);
+}
+
+/* compute the min-entropy of the distribution the alias table actually
+ * realizes so a tampered or badly quantized model cannot overstate it */
+static int
+model_state_entropy(const struct pwq_model_state *st, unsigned int *min_entropy)
+{
+        uint64_t weight[PWQ_MODEL_LETTERS];
+        uint64_t maxweight = 0;
+        int c;
+
+        memset(weight, 0, sizeof(weight));
+        for (c = 0; c < PWQ_MODEL_COLUMNS; c++) {
+                uint32_t prob = st->prob[c];
+
+                if (prob > PWQ_MODEL_PROB_ONE ||
+                    (c >= PWQ_MODEL_LETTERS && prob != 0) ||
+                    (prob < PWQ_MODEL_PROB_ONE &&
+                     st->alias[c] >= PWQ_MODEL_LETTERS))
+                        return -1;
+                if (prob > 0)
+                        weight[c] += prob;
+                if (prob < PWQ_MODEL_PROB_ONE)
+                        weight[st->alias[c]] += PWQ_MODEL_PROB_ONE - prob;
+        }
+        for (c = 0; c < PWQ_MODEL_LETTERS; c++) {
+                if (weight[c] > maxweight)
+                        maxweight = weight[c];
+        }
+
+        /* the weights sum up to PWQ_MODEL_COLUMNS * PWQ_MODEL_PROB_ONE */
+        *min_entropy = (PWQ_MODEL_COLUMN_BITS + PWQ_MODEL_PROB_BITS -
+                log2((double)maxweight)) * MODEL_ENTROPY_ONE;
+        return 0;
+}
+
+/* generate pronounceable segments of PWQ_MODEL_SEGMENT_LEN characters drawn
+ * from the model, each optionally capitalized and followed by a separator */
+static int
+generate_model(const struct pwq_model_state *states,
+               unsigned int *min_entropy, int entropy_bits, char *ptr)
+{
+        char entropy[MODEL_POOL_LEN];
+        int entropylen = sizeof(entropy);
+        long remaining = (long)entropy_bits * MODEL_ENTROPY_ONE;
+        int offset = entropylen * 8; /* force the initial fill */
+        int prev2 = 0, prev1 = 0;
+        int pos = 0;
+        int rv = PWQ_ERROR_RNG;
+
+        while (remaining > 0) {
+                int state = PWQ_MODEL_STATE(prev2, prev1);
+                unsigned int col, r, cap = 0;
+                int c;
+
+                if (min_entropy[state] == UINT_MAX &&
+                    model_state_entropy(&states[state], &min_entropy[state]) < 0) {
+                        rv = PWQ_ERROR_GEN_MODEL;
+                        goto out;
+                }
+
+                if (consume_entropy_long(entropy, entropylen,
+                        PWQ_MODEL_COLUMN_BITS, &offset, &col) < 0 ||
+                    consume_entropy_long(entropy, entropylen,
+                        PWQ_MODEL_PROB_BITS, &offset, &r) < 0)
+                        goto out;
+
+                c = r < states[state].prob[col] ? (int)col :
+                        states[state].alias[col];
+                remaining -= min_entropy[state];
+
+                if (pos == 0 && remaining > 0) {
+                        if (consume_entropy_long(entropy, entropylen, 1,
+                                                 &offset, &cap) < 0)
+                                goto out;
+                        remaining -= MODEL_ENTROPY_ONE;
+                }
+                *ptr++ = cap ? toupper('a' + c) : 'a' + c;
+                prev2 = prev1;
+                prev1 = c + 1;
+
+                if (++pos == PWQ_MODEL_SEGMENT_LEN && remaining > 0) {
+                        unsigned int idx;
+
+                        if (consume_entropy_long(entropy, entropylen, 4,
+                                                 &offset, &idx) < 0)
+                                goto out;
+                        remaining -= 4 * MODEL_ENTROPY_ONE;
+                        *ptr++ = separators[idx];
+                        prev2 = prev1 = 0;
+                        pos = 0;
+                }
+        }
+        rv = 0;
+
+out:
+        memset(entropy, '\0', sizeof(entropy));
+        return rv;
+}
+
 /* generate a random password according to the settings */
 int
 pwquality_generate(pwquality_settings_t *pwq, int entropy_bits, char **password)
 {
         char entropy[(PWQ_MAX_ENTROPY_BITS+PWQ_MAX_ENTROPY_BITS/9)/8 + 2];
+        const struct pwq_model_state *states = NULL;
+        unsigned int min_entropy[PWQ_MODEL_STATES];
+        void *map = NULL;
+        size_t maplen = 0;
         char *tmp;
         int maxlen;
         int try = 0;
@@ -115,11 +288,24 @@ pwquality_generate(pwquality_settings_t *pwq, int entropy_bits, char **password)
         if (entropy_bits < PWQ_MIN_ENTROPY_BITS)
                 entropy_bits = PWQ_MIN_ENTROPY_BITS;
 
-        /* overestimate here only 9 bits per syllable of 3 characters */
-        maxlen = (entropy_bits + 8) / 9 * 3 + 1;
+        if (pwq->gen_model) {
+                states = load_model(pwq->gen_model, &map, &maplen);
+                if (states == NULL)
+                        return PWQ_ERROR_GEN_MODEL;
+                /* not yet computed */
+                memset(min_entropy, 0xff, sizeof(min_entropy));
+                /* each segment carries at least the capitalization and
+                   separator bits */
+                maxlen = (entropy_bits + 4) / 5 * (PWQ_MODEL_SEGMENT_LEN + 1) + 1;
+        } else {
+                /* overestimate here only 9 bits per syllable of 3 characters */
+                maxlen = (entropy_bits + 8) / 9 * 3 + 1;
+        }
 
         tmp = malloc(maxlen);
         if (tmp == NULL) {
+                if (map)
+                        munmap(map, maplen);
                 return PWQ_ERROR_MEM_ALLOC;
         }
 
@@ -129,6 +315,19 @@ pwquality_generate(pwquality_settings_t *pwq, int entropy_bits, char **password)
                 char *ptr;
 
                 memset(tmp, '\0', maxlen);
+
+                if (states) {
+                        int rv;
+
+                        rv = generate_model(states, min_entropy, entropy_bits, tmp);
+                        if (rv < 0) {
+                                munmap(map, maplen);
+                                free(tmp);
+                                return rv;
+                        }
+                        continue;
+                }
+
                 /* read one more byte for rounding overflow during generation
                    and for at most every 9th bit we also drop one bit */
                 if (get_entropy_bits(entropy, entropy_bits +
@@ -164,6 +363,8 @@ pwquality_generate(pwquality_settings_t *pwq, int entropy_bits, char **password)
 
         /* clean up */
         memset(entropy, '\0', sizeof(entropy));
+        if (map)
+                munmap(map, maplen);
 
         if (try >= PWQ_NUM_GENERATION_TRIES) {
                 free(tmp);
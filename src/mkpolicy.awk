@@ -0,0 +1,109 @@
+#
+# Generate pwqpolicy.h with the check settings of a pwquality.conf file
+# for the builds configured with --with-fixed-policy.
+#
+# The file is parsed the same way as by pwquality_read_config(). The
+# settings that are not used by the check are left to the run time
+# configuration, the check settings missing in the file get the library
+# defaults.
+#
+# Copyright (c) Red Hat, Inc, 2026
+#
+
+function cstring(s,    i, c, r) {
+        r = ""
+        for (i = 1; i <= length(s); i++) {
+                c = substr(s, i, 1)
+                if (c == "\\" || c == "\"")
+                        r = r "\\"
+                r = r c
+        }
+        return "\"" r "\""
+}
+
+BEGIN {
+        n = split("difok:diff_ok:PWQ_DEFAULT_DIFF_OK " \
+                  "minlen:min_length:PWQ_DEFAULT_MIN_LENGTH " \
+                  "dcredit:dig_credit:PWQ_DEFAULT_DIG_CREDIT " \
+                  "ucredit:up_credit:PWQ_DEFAULT_UP_CREDIT " \
+                  "lcredit:low_credit:PWQ_DEFAULT_LOW_CREDIT " \
+                  "ocredit:oth_credit:PWQ_DEFAULT_OTH_CREDIT " \
+                  "minclass:min_class:0 " \
+                  "maxrepeat:max_repeat:0 " \
+                  "maxclassrepeat:max_class_repeat:0 " \
+                  "maxsequence:max_sequence:0 " \
+                  "gecoscheck:gecos_check:0 " \
+                  "dictcheck:dict_check:PWQ_DEFAULT_DICT_CHECK " \
+                  "usercheck:user_check:PWQ_DEFAULT_USER_CHECK " \
+                  "usersubstr:user_substr:PWQ_DEFAULT_USER_SUBSTR " \
+                  "oldsubstr:old_substr:PWQ_DEFAULT_OLD_SUBSTR " \
+                  "badwords:bad_words:NULL", settings, " ")
+        for (i = 1; i <= n; i++) {
+                split(settings[i], s, ":")
+                order[i] = s[1]
+                field[s[1]] = s[2]
+                value[s[1]] = s[3]
+        }
+        strsetting["badwords"] = 1
+}
+
+{
+        line = $0
+        sub(/#.*/, "", line)
+        sub(/^[ \t\r\v\f]+/, "", line)
+        sub(/[ \t\r\v\f]+$/, "", line)
+        if (line == "")
+                next
+
+        if (match(line, /[ \t\v\f=]/)) {
+                name = substr(line, 1, RSTART - 1)
+                eq = substr(line, RSTART, 1) == "="
+                val = substr(line, RSTART + 1)
+        } else {
+                name = line
+                eq = 0
+                val = ""
+        }
+        while (val != "") {
+                c = substr(val, 1, 1)
+                if (c == "=" && !eq)
+                        eq = 1
+                else if (c !~ /[ \t\v\f]/)
+                        break
+                val = substr(val, 2)
+        }
+
+        name = tolower(name)
+        if (!(name in field))
+                next
+
+        if (name in strsetting) {
+                value[name] = val == "" ? "NULL" : cstring(val)
+                next
+        }
+
+        # the same values as set_name_value() accepts
+        if (val !~ /^[-+]?[0-9]+$/ || val + 0 >= 2147483647 ||
+            val + 0 <= -2147483648) {
+                printf("%s:%d: Bad integer value of setting %s\n",
+                        FILENAME, FNR, name) > "/dev/stderr"
+                failed = 1
+                exit 1
+        }
+        val = val + 0
+        # the same limits as pwquality_set_int_value() applies
+        if (name == "minlen" && val < 6)
+                val = "PWQ_BASE_MIN_LENGTH"
+        if (name == "minclass" && val > 4)
+                val = "PWQ_NUM_CLASSES"
+        value[name] = val
+}
+
+END {
+        if (failed)
+                exit 1
+        print "/* Generated by mkpolicy.awk from " FILENAME ", do not edit. */"
+        print ""
+        for (i = 1; i <= n; i++)
+                print "#define PWQ_POLICY_" field[order[i]] " " value[order[i]]
+}
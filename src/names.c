@@ -0,0 +1,244 @@
+/*
+ * libpwquality check of the password against the index of all names
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+struct pwq_names_map {
+        void *addr;
+        size_t len;
+        const struct pwq_names_header *hdr;
+        const struct pwq_names_state *states;
+        const uint32_t *targets;
+        const uint8_t *labels;
+};
+
+/* the edges of every state lie in the table and lead to higher states, the
+   failure links to lower ones, so the scan needs no checks of its own */
+static int
+names_valid(const struct pwq_names_header *hdr,
+        const struct pwq_names_state *states, const uint32_t *targets)
+{
+        uint32_t s, e;
+        int c;
+
+        for (c = 0; c < 256; c++)
+                if (hdr->root[c] >= hdr->nstates)
+                        return 0;
+        for (s = 1; s < hdr->nstates; s++) {
+                if (states[s].fail >= s ||
+                    (uint64_t)states[s].edges + states[s].nedges > hdr->nedges)
+                        return 0;
+                for (e = states[s].edges; e < states[s].edges + states[s].nedges; e++)
+                        if (targets[e] <= s || targets[e] >= hdr->nstates)
+                                return 0;
+        }
+        return 1;
+}
+
+/* map the index and validate it once for all the checks */
+static struct pwq_names_map *
+names_map(const char *path)
+{
+        const struct pwq_names_header *hdr;
+        struct pwq_names_map *map;
+        struct stat st;
+        void *addr;
+        int fd;
+
+        fd = open(path, O_RDONLY|O_CLOEXEC);
+        if (fd == -1)
+                return NULL;
+        if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(*hdr)) {
+                (void)close(fd);
+                return NULL;
+        }
+        /* shared so all the processes use the same page cache */
+        addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        (void)close(fd);
+        if (addr == MAP_FAILED)
+                return NULL;
+
+        hdr = addr;
+        if (memcmp(hdr->magic, PWQ_NAMES_MAGIC, sizeof(hdr->magic)) != 0 ||
+            hdr->version != PWQ_NAMES_VERSION ||
+            hdr->endian != PWQ_NAMES_ENDIAN ||
+            hdr->size != (uint64_t)st.st_size || hdr->nstates == 0 ||
+            hdr->size != sizeof(*hdr) +
+                (uint64_t)hdr->nstates * sizeof(struct pwq_names_state) +
+                (uint64_t)hdr->nedges * (sizeof(uint32_t) + 1) ||
+            (map = malloc(sizeof(*map))) == NULL) {
+                munmap(addr, st.st_size);
+                return NULL;
+        }
+
+        map->addr = addr;
+        map->len = st.st_size;
+        map->hdr = hdr;
+        map->states = (const struct pwq_names_state *)(hdr + 1);
+        map->targets = (const uint32_t *)(map->states + hdr->nstates);
+        map->labels = (const uint8_t *)(map->targets + hdr->nedges);
+        if (!names_valid(hdr, map->states, map->targets)) {
+                munmap(addr, st.st_size);
+                free(map);
+                return NULL;
+        }
+        return map;
+}
+
+static void
+names_free(struct pwq_names_map *map)
+{
+        if (map) {
+                munmap(map->addr, map->len);
+                free(map);
+        }
+}
+
+/* the index is mapped once for the settings and their copies, concurrent
+   first checks may race to map it and all but one drop their mapping */
+static struct pwq_names_map *
+names_get(pwquality_settings_t *pwq)
+{
+        struct pwq_names_map *map, *expected = NULL;
+
+        map = __atomic_load_n(&pwq->names->map, __ATOMIC_ACQUIRE);
+        if (map)
+                return map;
+
+        map = names_map(pwq->name_index);
+        if (map == NULL)
+                return NULL;
+        if (!__atomic_compare_exchange_n(&pwq->names->map, &expected, map, 0,
+                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                names_free(map);
+                map = expected;
+        }
+        return map;
+}
+
+/* the target of the edge labeled c from the state s, 0 if there is none */
+static uint32_t
+names_next(const struct pwq_names_map *map, uint32_t s, unsigned char c)
+{
+        const struct pwq_names_state *st = &map->states[s];
+        uint32_t lo, hi;
+
+        if (s == 0)
+                return map->hdr->root[c];
+
+        lo = st->edges;
+        hi = st->edges + st->nedges;
+        while (lo < hi) {
+                uint32_t mid = lo + (hi - lo) / 2;
+
+                if (map->labels[mid] == c)
+                        return map->targets[mid];
+                if (map->labels[mid] < c)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+        return 0;
+}
+
+/* scan the lowercased password once for any of the names */
+int
+names_check(pwquality_settings_t *pwq, const char *new)
+{
+        const struct pwq_names_map *map;
+        const unsigned char *p;
+        uint32_t s = 0;
+
+        map = names_get(pwq);
+        if (map == NULL)
+                return PWQ_ERROR_NAME_INDEX;
+
+        for (p = (const unsigned char *)new; *p != '\0'; p++) {
+                uint32_t t;
+
+                while ((t = names_next(map, s, *p)) == 0 && s != 0)
+                        s = map->states[s].fail;
+                if (t != 0)
+                        s = t;
+                if (map->states[s].match)
+                        return PWQ_ERROR_NAMES;
+        }
+        return 0;
+}
+
+/* unmap the index with the last reference to it */
+void
+names_unload(pwquality_settings_t *pwq)
+{
+        struct pwq_names_ref *names = pwq->names;
+
+        pwq->names = NULL;
+        if (names == NULL || __atomic_sub_fetch(&names->refs, 1, __ATOMIC_ACQ_REL) > 0)
+                return;
+        names_free(names->map);
+        free(names);
+}
+
+/* map the index again on the next check after the nameindex changed,
+   the copies of the settings keep the old mapping */
+int
+names_reset(pwquality_settings_t *pwq)
+{
+        struct pwq_names_ref *names;
+
+        if ((names = calloc(1, sizeof(*names))) == NULL)
+                return PWQ_ERROR_MEM_ALLOC;
+        names->refs = 1;
+        names_unload(pwq);
+        pwq->names = names;
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
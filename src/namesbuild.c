@@ -0,0 +1,424 @@
+/*
+ * building of the index of names for the nameindex check, linked into
+ * pwmknames and pwqcheckdiff
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+/* the trie being built, the children of each state are linked in the
+   order of their labels */
+struct trie {
+        uint32_t *child;
+        uint32_t *sibling;
+        uint8_t *label;
+        uint8_t *term;
+        size_t n;
+        size_t alloc;
+};
+
+static int
+push(struct pwq_names_list *l, char *name)
+{
+        if (l->n == l->alloc) {
+                size_t alloc = l->alloc ? l->alloc * 2 : 1024;
+                char **v = realloc(l->v, alloc * sizeof(*v));
+
+                if (v == NULL)
+                        return -1;
+                l->v = v;
+                l->alloc = alloc;
+        }
+        l->v[l->n++] = name;
+        return 0;
+}
+
+/* add the name if it is long enough, the names are matched against
+   the lowercased password */
+int
+names_list_add(struct pwq_names_list *l, const char *s, size_t len)
+{
+        char *name;
+        size_t i;
+
+        if (len < PWQ_MIN_WORD_LENGTH)
+                return 0;
+        if ((name = malloc(len + 1)) == NULL)
+                return -1;
+        for (i = 0; i < len; i++)
+                name[i] = s[i] >= 'A' && s[i] <= 'Z' ? s[i] - 'A' + 'a' : s[i];
+        name[len] = '\0';
+        if (push(l, name) < 0) {
+                free(name);
+                return -1;
+        }
+        return 0;
+}
+
+static int
+compare(const void *a, const void *b)
+{
+        return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void
+sort_unique(struct pwq_names_list *l)
+{
+        size_t i, n = 0;
+
+        qsort(l->v, l->n, sizeof(*l->v), compare);
+        for (i = 0; i < l->n; i++) {
+                if (n > 0 && strcmp(l->v[n - 1], l->v[i]) == 0)
+                        free(l->v[i]);
+                else
+                        l->v[n++] = l->v[i];
+        }
+        l->n = n;
+}
+
+/* sort the names and add their reversals, the password is checked
+   for the reversed names too */
+int
+names_list_finish(struct pwq_names_list *l)
+{
+        size_t i, n;
+
+        sort_unique(l);
+        n = l->n;
+
+        for (i = 0; i < n; i++) {
+                size_t len = strlen(l->v[i]), j;
+                char *r = malloc(len + 1);
+
+                if (r == NULL || push(l, r) < 0) {
+                        free(r);
+                        return -1;
+                }
+                for (j = 0; j < len; j++)
+                        r[j] = l->v[i][len - 1 - j];
+                r[len] = '\0';
+        }
+        sort_unique(l);
+        return 0;
+}
+
+/* the index is rebuilt only when the names change */
+uint64_t
+names_list_digest(const struct pwq_names_list *l)
+{
+        unsigned char key[16];
+        uint64_t h = 0;
+        size_t i;
+
+        memset(key, 0, sizeof(key));
+        for (i = 0; i < l->n; i++) {
+                memcpy(key, &h, sizeof(h));
+                h = siphash24(key, l->v[i], strlen(l->v[i]) + 1);
+        }
+        return h;
+}
+
+static long
+new_state(struct trie *t, uint8_t label)
+{
+        if (t->n == t->alloc) {
+                size_t alloc = t->alloc ? t->alloc * 2 : 65536;
+                uint32_t *child, *sibling;
+                uint8_t *lab, *term;
+
+                if (alloc > INT32_MAX)
+                        return -1;
+                child = realloc(t->child, alloc * sizeof(*child));
+                if (child)
+                        t->child = child;
+                sibling = realloc(t->sibling, alloc * sizeof(*sibling));
+                if (sibling)
+                        t->sibling = sibling;
+                lab = realloc(t->label, alloc);
+                if (lab)
+                        t->label = lab;
+                term = realloc(t->term, alloc);
+                if (term)
+                        t->term = term;
+                if (!child || !sibling || !lab || !term)
+                        return -1;
+                t->alloc = alloc;
+        }
+        t->child[t->n] = 0;
+        t->sibling[t->n] = 0;
+        t->label[t->n] = label;
+        t->term[t->n] = 0;
+        return t->n++;
+}
+
+/* insert the sorted names, each one shares a prefix with the previous one
+   and its new state is the last child of the state at the end of it */
+static int
+build_trie(struct trie *t, const struct pwq_names_list *l)
+{
+        uint32_t *path = NULL;
+        size_t pathlen = 0, prevlen = 0, i;
+        const char *prev = "";
+
+        if (new_state(t, 0) < 0)
+                return -1;
+
+        for (i = 0; i < l->n; i++) {
+                const char *w = l->v[i];
+                size_t len = strlen(w), lcp = 0, d;
+
+                if (len + 1 > pathlen) {
+                        uint32_t *p = realloc(path, (len + 1) * sizeof(*p));
+
+                        if (p == NULL) {
+                                free(path);
+                                return -1;
+                        }
+                        path = p;
+                        pathlen = len + 1;
+                        path[0] = 0;
+                }
+                while (lcp < prevlen && w[lcp] == prev[lcp])
+                        ++lcp;
+
+                for (d = lcp; d < len; d++) {
+                        long s = new_state(t, (uint8_t)w[d]);
+
+                        if (s < 0) {
+                                free(path);
+                                return -1;
+                        }
+                        if (d == lcp && prevlen > lcp)
+                                t->sibling[path[d + 1]] = s;
+                        else
+                                t->child[path[d]] = s;
+                        path[d + 1] = s;
+                }
+                t->term[path[len]] = 1;
+                prev = w;
+                prevlen = len;
+        }
+        free(path);
+        return 0;
+}
+
+/* the target of the edge labeled c from the state s, 0 if there is none */
+static uint32_t
+next_state(const struct pwq_names_state *states, const uint32_t *targets,
+           const uint8_t *labels, uint32_t s, uint8_t c)
+{
+        uint32_t e;
+
+        for (e = states[s].edges; e < states[s].edges + states[s].nedges; e++) {
+                if (labels[e] == c)
+                        return targets[e];
+                if (labels[e] > c)
+                        break;
+        }
+        return 0;
+}
+
+/* lay out the states in the breadth-first order and add the failure links */
+static int
+build_index(const struct trie *t, struct pwq_names_header *hdr,
+            struct pwq_names_state **pstates, uint32_t **ptargets,
+            uint8_t **plabels)
+{
+        struct pwq_names_state *states;
+        uint32_t *order, *newid, *targets;
+        uint8_t *labels;
+        size_t n = t->n, head, tail = 1, e = 0;
+
+        order = malloc(n * sizeof(*order));
+        newid = malloc(n * sizeof(*newid));
+        states = calloc(n, sizeof(*states));
+        targets = malloc(n * sizeof(*targets));
+        labels = malloc(n);
+        if (!order || !newid || !states || !targets || !labels) {
+                free(order);
+                free(newid);
+                free(states);
+                free(targets);
+                free(labels);
+                return -1;
+        }
+
+        order[0] = 0;
+        newid[0] = 0;
+        for (head = 0; head < tail; head++) {
+                uint32_t c;
+
+                states[head].edges = e;
+                for (c = t->child[order[head]]; c != 0; c = t->sibling[c]) {
+                        newid[c] = tail;
+                        order[tail++] = c;
+                        targets[e] = newid[c];
+                        labels[e++] = t->label[c];
+                }
+                states[head].nedges = e - states[head].edges;
+        }
+
+        for (head = 0; head < n; head++) {
+                uint32_t i;
+
+                /* the failure link of the child and the one of the parent
+                   are on lower levels and already known */
+                for (i = states[head].edges; i < states[head].edges + states[head].nedges; i++) {
+                        uint32_t child = targets[i], f, g;
+
+                        if (head == 0) {
+                                states[child].fail = 0;
+                                hdr->root[labels[i]] = child;
+                        } else {
+                                for (f = states[head].fail;; f = states[f].fail) {
+                                        g = next_state(states, targets, labels, f, labels[i]);
+                                        if (g != 0 || f == 0)
+                                                break;
+                                }
+                                states[child].fail = g;
+                        }
+                        states[child].match = t->term[order[child]] ||
+                                states[states[child].fail].match;
+                }
+        }
+
+        free(order);
+        free(newid);
+        hdr->nstates = n;
+        hdr->nedges = e;
+        *pstates = states;
+        *ptargets = targets;
+        *plabels = labels;
+        return 0;
+}
+
+/* build the index and replace the file atomically so the checks never
+   map a partially written one, returns -1 with errno set on failure */
+int
+names_index_write(const struct pwq_names_list *l, uint64_t digest,
+        const char *path, unsigned long *nstates)
+{
+        struct pwq_names_header hdr;
+        struct pwq_names_state *states = NULL;
+        uint32_t *targets = NULL;
+        uint8_t *labels = NULL;
+        struct trie trie;
+        char *tmpname = NULL;
+        FILE *f;
+        int fd, saved, rv = -1;
+
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, PWQ_NAMES_MAGIC, sizeof(hdr.magic));
+        hdr.version = PWQ_NAMES_VERSION;
+        hdr.endian = PWQ_NAMES_ENDIAN;
+        hdr.nnames = l->n;
+        hdr.digest = digest;
+
+        memset(&trie, 0, sizeof(trie));
+        if (build_trie(&trie, l) < 0 ||
+            build_index(&trie, &hdr, &states, &targets, &labels) < 0 ||
+            asprintf(&tmpname, "%s.XXXXXX", path) < 0) {
+                tmpname = NULL;
+                errno = ENOMEM;
+                goto out;
+        }
+        hdr.size = sizeof(hdr) + (uint64_t)hdr.nstates * sizeof(*states) +
+                (uint64_t)hdr.nedges * (sizeof(*targets) + sizeof(*labels));
+
+        if ((fd = mkstemp(tmpname)) == -1)
+                goto out;
+        if (fchmod(fd, 0644) == -1 || (f = fdopen(fd, "w")) == NULL) {
+                saved = errno;
+                close(fd);
+                goto fail;
+        }
+        if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+            fwrite(states, sizeof(*states), hdr.nstates, f) != hdr.nstates ||
+            fwrite(targets, sizeof(*targets), hdr.nedges, f) != hdr.nedges ||
+            fwrite(labels, sizeof(*labels), hdr.nedges, f) != hdr.nedges) {
+                saved = errno;
+                fclose(f);
+                goto fail;
+        }
+        if (fclose(f) != 0 || rename(tmpname, path) == -1) {
+                saved = errno;
+                goto fail;
+        }
+
+        if (nstates)
+                *nstates = hdr.nstates;
+        rv = 0;
+        goto out;
+
+fail:
+        unlink(tmpname);
+        errno = saved;
+out:
+        saved = errno;
+        free(trie.child);
+        free(trie.sibling);
+        free(trie.label);
+        free(trie.term);
+        free(states);
+        free(targets);
+        free(labels);
+        free(tmpname);
+        errno = saved;
+        return rv;
+}
+
+void
+names_list_free(struct pwq_names_list *l)
+{
+        size_t i;
+
+        for (i = 0; i < l->n; i++)
+                free(l->v[i]);
+        free(l->v);
+        memset(l, 0, sizeof(*l));
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -0,0 +1,325 @@
+/*
+ * pwaudit - a tool for checking lists of passwords
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+#define MAX_KEY_FILE_LEN 4096
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-q] [-v] [-U | -u passwdfile] [-s summary [-k keyfile]]\n"), progname);
+        fprintf(stderr, _("       %s -m [-q] [-s summary] <summary>...\n"), progname);
+        fprintf(stderr, _("       The command reads lines of the form [user<TAB>]password[<TAB>oldpassword]\n"
+                          "       from the standard input and prints the check result of each line.\n"
+                          "       With -s it also writes the summary of the results that can be merged\n"
+                          "       with the summaries of other audits made with the same key by -m.\n"
+                          "       With -U or -u it reads the GECOS fields of all users at the start.\n"));
+}
+
+/* Derive the summary key from the contents of the key file or make
+ * a random one, the summaries made with a random key cannot be merged
+ * with other ones. */
+static int
+summary_key(const char *keyfile, unsigned char *key)
+{
+        static const unsigned char kdf[2][PWQ_SUMMARY_KEY_LEN] = {
+                "pwaudit summary1", "pwaudit summary2"
+        };
+        unsigned char data[MAX_KEY_FILE_LEN];
+        uint64_t half;
+        size_t len;
+        FILE *f;
+        int i;
+
+        f = fopen(keyfile ? keyfile : "/dev/urandom", "r");
+        if (f == NULL)
+                return -1;
+        len = fread(data, 1, keyfile ? sizeof(data) : PWQ_SUMMARY_KEY_LEN, f);
+        if (ferror(f) || len == 0) {
+                fclose(f);
+                if (len == 0)
+                        errno = ENODATA;
+                return -1;
+        }
+        fclose(f);
+
+        for (i = 0; i < 2; i++) {
+                half = siphash24(kdf[i], data, len);
+                memcpy(key + i * sizeof(half), &half, sizeof(half));
+        }
+        memset(data, 0, sizeof(data));
+        return 0;
+}
+
+/* merge the summaries and print the report */
+static int
+merge(int quiet, const char *output, int nfiles, char *files[])
+{
+        struct pwq_summary *total, *s;
+        int i, rv;
+
+        total = malloc(sizeof(*total));
+        s = malloc(sizeof(*s));
+        if (total == NULL || s == NULL) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                return 2;
+        }
+
+        for (i = 0; i < nfiles; i++) {
+                rv = summary_read(files[i], i ? s : total);
+                if (rv == -1) {
+                        fprintf(stderr, _("Error: Cannot read %s: %s\n"), files[i], strerror(errno));
+                        return 1;
+                }
+                if (rv == -2) {
+                        fprintf(stderr, _("Error: %s is not a valid summary\n"), files[i]);
+                        return 1;
+                }
+                if (i && summary_merge(total, s) < 0) {
+                        fprintf(stderr, _("Error: %s was made with a different key than %s\n"),
+                                files[i], files[0]);
+                        return 1;
+                }
+        }
+
+        if (output && summary_write(output, total) < 0) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), output, strerror(errno));
+                return 1;
+        }
+        if (!quiet)
+                summary_report(total);
+
+        free(s);
+        free(total);
+        return 0;
+}
+
+static double
+elapsed(const struct timespec *start)
+{
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - start->tv_sec) +
+                (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* check a list of passwords */
+int
+main(int argc, char *argv[])
+{
+        pwquality_settings_t *pwq;
+        pwquality_batch_t *batch;
+        struct pwq_summary *summary = NULL;
+        unsigned char key[PWQ_SUMMARY_KEY_LEN];
+        const char *output = NULL, *keyfile = NULL, *passwdfile = NULL;
+        struct timespec start;
+        unsigned long checks, hits;
+        unsigned long lineno = 0;
+        int quiet = 0, verbose = 0, merging = 0, prefetch = 0;
+        int rv, opt;
+        void *auxerror;
+        char *line = NULL;
+        size_t linesize = 0;
+        ssize_t len;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        while ((opt = getopt(argc, argv, "qvs:k:mUu:")) != -1) {
+                switch (opt) {
+                case 'q':
+                        quiet = 1;
+                        break;
+                case 'v':
+                        verbose = 1;
+                        break;
+                case 's':
+                        output = optarg;
+                        break;
+                case 'k':
+                        keyfile = optarg;
+                        break;
+                case 'm':
+                        merging = 1;
+                        break;
+                case 'U':
+                        prefetch = 1;
+                        passwdfile = NULL;
+                        break;
+                case 'u':
+                        prefetch = 1;
+                        passwdfile = optarg;
+                        break;
+                default:
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+        }
+
+        if (merging ? optind == argc || keyfile != NULL || verbose || prefetch :
+            optind != argc || (keyfile != NULL && output == NULL)) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+        if (merging)
+                return merge(quiet, output, argc - optind, argv + optind);
+
+        if (output) {
+                summary = malloc(sizeof(*summary));
+                if (summary == NULL) {
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                        exit(2);
+                }
+                if (summary_key(keyfile, key) < 0) {
+                        fprintf(stderr, _("Error: Cannot read %s: %s\n"),
+                                keyfile ? keyfile : "/dev/urandom", strerror(errno));
+                        exit(3);
+                }
+                summary_init(summary, key);
+        }
+
+        pwq = pwquality_default_settings();
+        if (pwq == NULL) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+
+        if ((rv=pwquality_read_config(pwq, NULL, &auxerror)) != 0) {
+                pwquality_free_settings(pwq);
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, rv, auxerror));
+                exit(3);
+        }
+
+        batch = pwquality_batch_new(pwq);
+        if (batch == NULL) {
+                pwquality_free_settings(pwq);
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        if (prefetch &&
+            (rv=pwquality_batch_prefetch_users(batch, passwdfile)) != 0) {
+                pwquality_batch_free(batch);
+                pwquality_free_settings(pwq);
+                if (rv == PWQ_ERROR_USERS_PREFETCH && passwdfile)
+                        fprintf(stderr, _("Error: Cannot read %s\n"), passwdfile);
+                else
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, rv, NULL));
+                exit(rv == PWQ_ERROR_MEM_ALLOC ? 2 : 3);
+        }
+
+        while ((len = getline(&line, &linesize, stdin)) != -1) {
+                char *user = NULL, *password = line, *oldpassword = NULL;
+                char *tab;
+                char buf[PWQ_MAX_ERROR_MESSAGE_LEN];
+
+                ++lineno;
+                if (len > 0 && line[len - 1] == '\n')
+                        line[--len] = '\0';
+
+                if ((tab = strchr(line, '\t')) != NULL) {
+                        *tab = '\0';
+                        user = line;
+                        password = tab + 1;
+                        if ((tab = strchr(password, '\t')) != NULL) {
+                                *tab = '\0';
+                                oldpassword = tab + 1;
+                        }
+                }
+
+                rv = pwquality_batch_check(batch, password, oldpassword, user, &auxerror);
+                if (summary)
+                        summary_add(summary, key, password, rv);
+                memset(line, 0, len);
+
+                if (quiet)
+                        continue;
+                if (rv < 0)
+                        printf("%lu\t%d\t%s\n", lineno, rv,
+                                pwquality_strerror(buf, sizeof(buf), rv, auxerror));
+                else
+                        printf("%lu\t%d\n", lineno, rv);
+        }
+
+        if (verbose) {
+                pwquality_batch_stats(batch, &checks, &hits);
+                fprintf(stderr, _("Checked %lu passwords in %.3f seconds, %lu (%.1f%%) were repeated inputs\n"),
+                        checks, elapsed(&start), hits,
+                        checks ? 100.0 * hits / checks : 0.0);
+        }
+
+        pwquality_batch_free(batch);
+        pwquality_free_settings(pwq);
+        if (line) {
+                memset(line, 0, linesize);
+                free(line);
+        }
+
+        if (summary) {
+                memset(key, 0, sizeof(key));
+                rv = summary_write(output, summary);
+                free(summary);
+                if (rv < 0) {
+                        fprintf(stderr, _("Error: Cannot write %s: %s\n"), output, strerror(errno));
+                        return 1;
+                }
+        }
+
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -0,0 +1,251 @@
+/*
+ * pwmkmodel - a tool for building the password generation model
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <ctype.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+/* weight of the lower order distribution when smoothing the transitions
+ * that are rare or unseen in the word list */
+#define BACKOFF_WEIGHT 4.0
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s <wordlist> <model-file>\n"), progname);
+        fprintf(stderr, _("       The command builds the password generation model from the word list.\n"));
+}
+
+static unsigned long count3[PWQ_MODEL_STATES][PWQ_MODEL_LETTERS];
+static unsigned long count2[PWQ_MODEL_SYMBOLS][PWQ_MODEL_LETTERS];
+
+static unsigned long
+count_words(FILE *f)
+{
+        unsigned long words = 0;
+        int prev2 = 0, prev1 = 0;
+        int ch;
+
+        while ((ch = getc(f)) != EOF) {
+                if (isascii(ch) && isalpha(ch)) {
+                        int c = tolower(ch) - 'a';
+
+                        if (prev1 == 0)
+                                ++words;
+                        ++count3[PWQ_MODEL_STATE(prev2, prev1)][c];
+                        ++count2[prev1][c];
+                        prev2 = prev1;
+                        prev1 = c + 1;
+                } else {
+                        /* anything else is a word boundary */
+                        prev2 = prev1 = 0;
+                }
+        }
+        return words;
+}
+
+/* Vose's construction of the alias table quantized to PWQ_MODEL_PROB_BITS */
+static void
+build_alias(const double *p, struct pwq_model_state *st)
+{
+        double scaled[PWQ_MODEL_COLUMNS];
+        int small[PWQ_MODEL_COLUMNS], large[PWQ_MODEL_COLUMNS];
+        int nsmall = 0, nlarge = 0;
+        int c, top = 0;
+
+        for (c = 0; c < PWQ_MODEL_COLUMNS; c++) {
+                scaled[c] = c < PWQ_MODEL_LETTERS ? p[c] * PWQ_MODEL_COLUMNS : 0.0;
+                if (scaled[c] < 1.0)
+                        small[nsmall++] = c;
+                else
+                        large[nlarge++] = c;
+                if (c < PWQ_MODEL_LETTERS && p[c] > p[top])
+                        top = c;
+        }
+
+        while (nsmall > 0 && nlarge > 0) {
+                int l = small[--nsmall];
+                int g = large[--nlarge];
+
+                st->prob[l] = llround(scaled[l] * PWQ_MODEL_PROB_ONE);
+                st->alias[l] = g;
+                scaled[g] = scaled[g] + scaled[l] - 1.0;
+                if (scaled[g] < 1.0)
+                        small[nsmall++] = g;
+                else
+                        large[nlarge++] = g;
+        }
+
+        /* whatever is left is full up to the rounding errors */
+        while (nlarge > 0) {
+                c = large[--nlarge];
+                st->prob[c] = PWQ_MODEL_PROB_ONE;
+                st->alias[c] = c;
+        }
+        while (nsmall > 0) {
+                c = small[--nsmall];
+                st->prob[c] = c < PWQ_MODEL_LETTERS ? PWQ_MODEL_PROB_ONE : 0;
+                st->alias[c] = c < PWQ_MODEL_LETTERS ? c : top;
+        }
+
+        for (c = PWQ_MODEL_LETTERS; c < PWQ_MODEL_COLUMNS; c++)
+                st->prob[c] = 0;
+        for (c = 0; c < PWQ_MODEL_COLUMNS; c++) {
+                if (st->prob[c] > PWQ_MODEL_PROB_ONE)
+                        st->prob[c] = PWQ_MODEL_PROB_ONE;
+        }
+}
+
+static void
+build_model(struct pwq_model_state *states)
+{
+        int prev2, prev1, c;
+
+        for (prev2 = 0; prev2 < PWQ_MODEL_SYMBOLS; prev2++) {
+                for (prev1 = 0; prev1 < PWQ_MODEL_SYMBOLS; prev1++) {
+                        int state = PWQ_MODEL_STATE(prev2, prev1);
+                        double p[PWQ_MODEL_LETTERS];
+                        unsigned long total2 = 0, total3 = 0;
+
+                        for (c = 0; c < PWQ_MODEL_LETTERS; c++) {
+                                total2 += count2[prev1][c];
+                                total3 += count3[state][c];
+                        }
+
+                        /* the first order distribution with add-one smoothing
+                           is the fallback for the second order one */
+                        for (c = 0; c < PWQ_MODEL_LETTERS; c++) {
+                                double p2 = (count2[prev1][c] + 1.0) /
+                                        (total2 + PWQ_MODEL_LETTERS);
+
+                                p[c] = (count3[state][c] + BACKOFF_WEIGHT * p2) /
+                                        (total3 + BACKOFF_WEIGHT);
+                        }
+
+                        build_alias(p, &states[state]);
+                }
+        }
+}
+
+/* build the password generation model */
+int
+main(int argc, char *argv[])
+{
+        struct pwq_model_header hdr;
+        struct pwq_model_state *states;
+        char *tmpname;
+        unsigned long words;
+        FILE *f;
+        int fd;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        if (argc != 3) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+        f = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "r");
+        if (f == NULL) {
+                fprintf(stderr, _("Error: Cannot open %s: %s\n"), argv[1], strerror(errno));
+                exit(2);
+        }
+        words = count_words(f);
+        if (f != stdin)
+                fclose(f);
+
+        if (words == 0) {
+                fprintf(stderr, _("Error: No words found in %s\n"), argv[1]);
+                exit(1);
+        }
+
+        states = calloc(PWQ_MODEL_STATES, sizeof(*states));
+        if (states == NULL) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+        build_model(states);
+
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, PWQ_MODEL_MAGIC, sizeof(hdr.magic));
+        hdr.version = PWQ_MODEL_VERSION;
+        hdr.columns = PWQ_MODEL_COLUMNS;
+        hdr.states = PWQ_MODEL_STATES;
+        hdr.endian = PWQ_MODEL_ENDIAN;
+
+        /* replace the model atomically so pwquality_generate() never
+           maps a partially written file */
+        if (asprintf(&tmpname, "%s.XXXXXX", argv[2]) < 0) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+        fd = mkstemp(tmpname);
+        if (fd == -1 || fchmod(fd, 0644) == -1 ||
+            (f = fdopen(fd, "w")) == NULL ||
+            fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+            fwrite(states, sizeof(*states), PWQ_MODEL_STATES, f) != PWQ_MODEL_STATES ||
+            fclose(f) != 0 ||
+            rename(tmpname, argv[2]) == -1) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), argv[2], strerror(errno));
+                if (fd != -1)
+                        unlink(tmpname);
+                exit(1);
+        }
+
+        printf(_("Model built from %lu words\n"), words);
+        free(tmpname);
+        free(states);
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -0,0 +1,299 @@
+/*
+ * pwmknames - a tool for building the index of names for the nameindex check
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <pwd.h>
+#include <unistd.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-f] [-U] [-p passwdfile]... [-w namefile]... <index-file>\n"), progname);
+        fprintf(stderr, _("       The command builds the index of the user names, the names from their GECOS\n"
+                          "       fields and the names in the name files for the nameindex check.\n"));
+}
+
+static int
+name_char(unsigned char c)
+{
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+                (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+/* add the parts of the string separated by other characters than letters
+   and digits, and optionally the whole string without surrounding space */
+static int
+add_tokens(struct pwq_names_list *l, const char *s, size_t len, int whole)
+{
+        size_t i = 0, start;
+
+        if (whole) {
+                while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\t' ||
+                       s[len - 1] == '\r'))
+                        --len;
+                while (len > 0 && (*s == ' ' || *s == '\t')) {
+                        ++s;
+                        --len;
+                }
+                if (names_list_add(l, s, len) < 0)
+                        return -1;
+        }
+
+        while (i < len) {
+                while (i < len && !name_char(s[i]))
+                        ++i;
+                start = i;
+                while (i < len && name_char(s[i]))
+                        ++i;
+                if ((!whole || i - start < len) &&
+                    names_list_add(l, s + start, i - start) < 0)
+                        return -1;
+        }
+        return 0;
+}
+
+/* the user name and the name part of the GECOS field before the comma */
+static int
+add_user(struct pwq_names_list *l, const char *name, const char *gecos)
+{
+        if (add_tokens(l, name, strlen(name), 1) < 0)
+                return -1;
+        if (gecos && add_tokens(l, gecos, strcspn(gecos, ","), 0) < 0)
+                return -1;
+        return 0;
+}
+
+static int
+read_passwd(struct pwq_names_list *l, const char *path)
+{
+        char *line = NULL;
+        size_t linesize = 0;
+        ssize_t len;
+        FILE *f;
+        int rv = 0;
+
+        if ((f = fopen(path, "r")) == NULL)
+                return -1;
+
+        while (!rv && (len = getline(&line, &linesize, f)) != -1) {
+                char *gecos = line;
+                int i;
+
+                if (len > 0 && line[len - 1] == '\n')
+                        line[--len] = '\0';
+                if (*line == '\0' || *line == '#' || *line == '+' || *line == '-')
+                        continue;
+
+                /* name:password:uid:gid:gecos:dir:shell */
+                for (i = 0; i < 4 && gecos != NULL; i++) {
+                        gecos = strchr(gecos, ':');
+                        if (gecos)
+                                *gecos++ = '\0';
+                }
+                if (gecos == NULL)
+                        continue;
+                rv = add_user(l, line, gecos);
+        }
+
+        if (ferror(f))
+                rv = -1;
+        free(line);
+        fclose(f);
+        return rv;
+}
+
+/* one name per line, the lines starting with # are ignored */
+static int
+read_namefile(struct pwq_names_list *l, const char *path)
+{
+        char *line = NULL;
+        size_t linesize = 0;
+        ssize_t len;
+        FILE *f;
+        int rv = 0;
+
+        f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+        if (f == NULL)
+                return -1;
+
+        while (!rv && (len = getline(&line, &linesize, f)) != -1) {
+                if (len > 0 && line[len - 1] == '\n')
+                        line[--len] = '\0';
+                if (*line == '#')
+                        continue;
+                rv = add_tokens(l, line, len, 1);
+        }
+
+        if (ferror(f))
+                rv = -1;
+        free(line);
+        if (f != stdin)
+                fclose(f);
+        return rv;
+}
+
+static int
+enumerate(struct pwq_names_list *l)
+{
+        struct passwd *pwd;
+        int rv = 0;
+
+        setpwent();
+        while (!rv && (pwd = getpwent()) != NULL)
+                rv = add_user(l, pwd->pw_name, pwd->pw_gecos);
+        endpwent();
+        return rv;
+}
+
+static int
+up_to_date(const char *path, const struct pwq_names_list *l, uint64_t digest)
+{
+        struct pwq_names_header hdr;
+        FILE *f;
+        int rv = 0;
+
+        if ((f = fopen(path, "r")) == NULL)
+                return 0;
+        if (fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+            memcmp(hdr.magic, PWQ_NAMES_MAGIC, sizeof(hdr.magic)) == 0 &&
+            hdr.version == PWQ_NAMES_VERSION &&
+            hdr.endian == PWQ_NAMES_ENDIAN &&
+            hdr.nnames == l->n && hdr.digest == digest)
+                rv = 1;
+        fclose(f);
+        return rv;
+}
+
+/* build the name index */
+int
+main(int argc, char *argv[])
+{
+        struct pwq_names_list names = { NULL, 0, 0 };
+        const char *output;
+        unsigned long nstates;
+        uint64_t digest;
+        int force = 0, sources = 0;
+        int opt, rv = 0;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        while (rv == 0 && (opt = getopt(argc, argv, "fUp:w:")) != -1) {
+                switch (opt) {
+                case 'f':
+                        force = 1;
+                        continue;
+                case 'U':
+                        rv = enumerate(&names);
+                        break;
+                case 'p':
+                        rv = read_passwd(&names, optarg);
+                        break;
+                case 'w':
+                        rv = read_namefile(&names, optarg);
+                        break;
+                default:
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+                ++sources;
+                if (rv < 0) {
+                        if (errno == ENOMEM)
+                                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                        else if (opt == 'U')
+                                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_USERS_PREFETCH, NULL));
+                        else
+                                fprintf(stderr, _("Error: Cannot read %s: %s\n"), optarg, strerror(errno));
+                        exit(2);
+                }
+        }
+
+        if (sources == 0 || optind != argc - 1) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+        output = argv[optind];
+
+        if (names.n == 0) {
+                fprintf(stderr, _("Error: No names found\n"));
+                exit(1);
+        }
+        if (names_list_finish(&names) < 0) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+        digest = names_list_digest(&names);
+
+        /* leave the index alone if the names did not change so the
+           periodic rebuilds do not replace it needlessly */
+        if (!force && up_to_date(output, &names, digest)) {
+                printf(_("Index of %lu names is up to date\n"), (unsigned long)names.n);
+                return 0;
+        }
+
+        if (names_index_write(&names, digest, output, &nstates) < 0) {
+                if (errno == ENOMEM) {
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                        exit(2);
+                }
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), output, strerror(errno));
+                exit(1);
+        }
+
+        printf(_("Index of %lu names with %lu states written\n"),
+                (unsigned long)names.n, nstates);
+
+        names_list_free(&names);
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
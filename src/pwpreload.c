@@ -0,0 +1,216 @@
+/*
+ * pwpreload - a tool for keeping the dictionary in memory
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <locale.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+#define BENCH_PASSWORD "Ao5!xq.Vemb7"
+
+static const char *dict_suffixes[PWQ_DICT_FILES] = PWQ_DICT_SUFFIXES;
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-l | -e | -b <count>]\n"), progname);
+        fprintf(stderr, _("       The command reads the dictionary into memory.\n"));
+}
+
+static double
+now_usec(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* drop the dictionary from the page cache */
+static int
+evict(const char *dict)
+{
+        size_t i;
+
+        for (i = 0; i < PWQ_DICT_FILES; i++) {
+                char path[PATH_MAX];
+                int fd;
+
+                snprintf(path, sizeof(path), "%s%s", dict, dict_suffixes[i]);
+                fd = open(path, O_RDONLY);
+                if (fd == -1) {
+                        if (errno == ENOENT)
+                                continue;
+                        fprintf(stderr, _("Error: Cannot open %s: %s\n"), path, strerror(errno));
+                        return -1;
+                }
+                (void)fdatasync(fd);
+                (void)posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+        }
+        return 0;
+}
+
+static int
+bench(pwquality_settings_t *pwq, const char *dict, long count)
+{
+        double start, first, total = 0;
+        long i;
+
+        if (evict(dict) < 0)
+                return -1;
+
+        start = now_usec();
+        pwquality_check(pwq, BENCH_PASSWORD, NULL, NULL, NULL);
+        first = now_usec() - start;
+
+        for (i = 0; i < count; i++) {
+                start = now_usec();
+                pwquality_check(pwq, BENCH_PASSWORD, NULL, NULL, NULL);
+                total += now_usec() - start;
+        }
+
+        printf(_("First check: %.0f us\n"), first);
+        if (count > 0)
+                printf(_("Steady state: %.1f us per check\n"), total / count);
+        return 0;
+}
+
+/* read the dictionary into memory */
+int
+main(int argc, char *argv[])
+{
+        pwquality_settings_t *pwq;
+        const char *dict = NULL;
+        char *endptr;
+        long count = 0;
+        int mode = 0;
+        int rv, opt;
+        void *auxerror;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        while ((opt = getopt(argc, argv, "leb:")) != -1) {
+                if (mode) {
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+                mode = opt;
+                if (opt == 'b') {
+                        errno = 0;
+                        count = strtol(optarg, &endptr, 10);
+                        if (errno != 0 || *optarg == '\0' || *endptr != '\0' ||
+                            count < 0) {
+                                usage(basename(argv[0]));
+                                exit(3);
+                        }
+                } else if (opt != 'l' && opt != 'e') {
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+        }
+
+        if (optind != argc) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+        pwq = pwquality_default_settings();
+        if (pwq == NULL) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+
+        if ((rv=pwquality_read_config(pwq, NULL, &auxerror)) != 0) {
+                pwquality_free_settings(pwq);
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, rv, auxerror));
+                exit(3);
+        }
+
+        if (pwquality_get_str_value(pwq, PWQ_SETTING_DICT_PATH, &dict) != 0 ||
+            dict == NULL) {
+                pwquality_free_settings(pwq);
+                fprintf(stderr, _("Error: %s\n"), _("No dictionary is configured"));
+                exit(1);
+        }
+
+        switch (mode) {
+        case 'e':
+                rv = evict(dict) < 0 ? 1 : 0;
+                break;
+        case 'b':
+                rv = bench(pwq, dict, count) < 0 ? 1 : 0;
+                break;
+        case 'l':
+                pwquality_set_int_value(pwq, PWQ_SETTING_DICT_PRELOAD, 2);
+                /* fall through */
+        default:
+                if ((rv = pwquality_preload_dict(pwq)) != 0) {
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, rv, NULL));
+                        rv = 1;
+                        break;
+                }
+                if (mode == 'l') {
+                        /* hold the locked dictionary until terminated */
+                        for (;;)
+                                pause();
+                }
+                break;
+        }
+
+        pwquality_free_settings(pwq);
+        return rv;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
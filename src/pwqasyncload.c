@@ -0,0 +1,360 @@
+/*
+ * pwqasyncload - a load test of the event loop latency with the asynchronous
+ * check API
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <poll.h>
+#include <pwd.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "pwquality.h"
+
+#define MAX_THREADS 256
+#define USERS 1000
+#define GECOS "Load Test User,Room 101,555-0100"
+
+struct loop {
+        pwquality_settings_t *pwq;
+        unsigned long nticks;
+        unsigned long perticks;
+        uint64_t tick_ns;
+        uint32_t *interval;  /* between the handled ticks */
+        uint32_t *latency;   /* of the checks */
+        uint64_t *submitted; /* indexed by the check number */
+        unsigned long rejected;
+        uint64_t rng;
+};
+
+/* delay of the passwd lookups of the odd users */
+static unsigned long delay_us = 5000;
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-n ticks] [-k checks] [-t tick-us] [-j threads] [-d delay-us]\n"
+                          "       [config]\n"), progname);
+        fprintf(stderr, _("       The command runs an event loop submitting the checks on each timer tick,\n"
+                          "       first synchronously and then with the asynchronous API, and reports the\n"
+                          "       intervals between the handled ticks and the latency of the checks.\n"));
+}
+
+static uint64_t
+now_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t
+rnd(uint64_t *state, uint32_t n)
+{
+        /* xorshift64*, the inputs need not be unpredictable */
+        *state ^= *state >> 12;
+        *state ^= *state << 25;
+        *state ^= *state >> 27;
+        return ((*state * 0x2545F4914F6CDD1DULL) >> 32) % n;
+}
+
+static void
+nomem(void)
+{
+        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+        exit(2);
+}
+
+static char *
+put(char **buf, size_t *buflen, const char *s)
+{
+        size_t len = strlen(s) + 1;
+        char *p = *buf;
+
+        if (len > *buflen)
+                return NULL;
+        memcpy(p, s, len);
+        *buf += len;
+        *buflen -= len;
+        return p;
+}
+
+/* overrides the lookup of the library with made-up entries, the odd
+   users are delayed as if they missed the NSS cache */
+int
+getpwnam_r(const char *name, struct passwd *pwd, char *buf, size_t buflen,
+        struct passwd **result)
+{
+        unsigned long n;
+        char *end;
+
+        *result = NULL;
+        if (strncmp(name, "user", 4) != 0)
+                return 0;
+        n = strtoul(name + 4, &end, 10);
+        if (*end != '\0')
+                return 0;
+        if (n % 2)
+                usleep(delay_us);
+
+        memset(pwd, 0, sizeof(*pwd));
+        pwd->pw_uid = 1000 + n;
+        pwd->pw_gid = 100;
+        if ((pwd->pw_name = put(&buf, &buflen, name)) == NULL ||
+            (pwd->pw_passwd = put(&buf, &buflen, "x")) == NULL ||
+            (pwd->pw_gecos = put(&buf, &buflen, GECOS)) == NULL ||
+            (pwd->pw_dir = put(&buf, &buflen, "/")) == NULL ||
+            (pwd->pw_shell = put(&buf, &buflen, "/bin/sh")) == NULL)
+                return ERANGE;
+        *result = pwd;
+        return 0;
+}
+
+static void
+make_input(struct loop *l, char *password, char *user)
+{
+        static const char chars[] = "abcdefghijklmnopqrstuvwxyz"
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!#%+-.:=?@_";
+        int i;
+
+        for (i = 0; i < 12; i++)
+                password[i] = chars[rnd(&l->rng, sizeof(chars) - 1)];
+        password[i] = '\0';
+        sprintf(user, "user%u", rnd(&l->rng, USERS));
+}
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+        uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+        return x < y ? -1 : x > y;
+}
+
+static void
+report(const char *mode, uint32_t *v, size_t n, uint32_t *c, size_t nc,
+        unsigned long rejected)
+{
+        qsort(v, n, sizeof(*v), cmp_u32);
+        qsort(c, nc, sizeof(*c), cmp_u32);
+        printf("%-12s %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %9lu\n", mode,
+                v[n / 2] / 1e3, v[n * 99 / 100] / 1e3, v[n - 1] / 1e3,
+                c[nc / 2] / 1e3, c[nc * 99 / 100] / 1e3, c[nc - 1] / 1e3,
+                rejected);
+        fflush(stdout);
+}
+
+/* fetch the completed checks, returns their number */
+static unsigned long
+fetch(struct loop *l, pwquality_async_t *async)
+{
+        unsigned long n = 0;
+        void *cookie, *auxerror;
+        int result;
+
+        while (pwquality_async_result(async, &cookie, &result, &auxerror)) {
+                uintptr_t i = (uintptr_t)cookie;
+
+                l->latency[i] = now_ns() - l->submitted[i];
+                if (result < 0) {
+                        l->rejected++;
+                        pwquality_strerror(NULL, 0, result, auxerror);
+                }
+                n++;
+        }
+        return n;
+}
+
+/* handle the ticks of the loop on time, with async NULL the checks are
+   run synchronously in the loop */
+static void
+run_loop(struct loop *l, pwquality_async_t *async)
+{
+        char password[16], user[16];
+        struct pollfd pfd;
+        struct timespec ts;
+        uint64_t next, last, t;
+        unsigned long tick = 0, checks = 0, done = 0, i;
+
+        pfd.fd = async ? pwquality_async_fd(async) : -1;
+        pfd.events = POLLIN;
+        l->rejected = 0;
+        last = now_ns();
+        next = last + l->tick_ns;
+
+        while (tick < l->nticks || done < checks) {
+                t = now_ns();
+                if (tick < l->nticks && t >= next) {
+                        l->interval[tick++] = t - last;
+                        last = t;
+                        next += l->tick_ns;
+                        for (i = 0; i < l->perticks; i++, checks++) {
+                                void *auxerror = NULL;
+                                int rv;
+
+                                make_input(l, password, user);
+                                l->submitted[checks] = now_ns();
+                                if (async) {
+                                        if (pwquality_check_async(async, password,
+                                                NULL, user, (void *)(uintptr_t)checks) < 0)
+                                                nomem();
+                                        continue;
+                                }
+                                rv = pwquality_check(l->pwq, password, NULL, user, &auxerror);
+                                l->latency[checks] = now_ns() - l->submitted[checks];
+                                if (rv < 0) {
+                                        l->rejected++;
+                                        pwquality_strerror(NULL, 0, rv, auxerror);
+                                }
+                                done++;
+                        }
+                        continue;
+                }
+                /* sleep until the next tick or a completion */
+                t = tick < l->nticks ? next - t : 1000000000;
+                ts.tv_sec = t / 1000000000;
+                ts.tv_nsec = t % 1000000000;
+                if (ppoll(&pfd, 1, &ts, NULL) > 0)
+                        done += fetch(l, async);
+        }
+}
+
+int
+main(int argc, char *argv[])
+{
+        struct loop l;
+        pwquality_async_t *async;
+        void *auxerror;
+        char mode[16];
+        size_t nchecks;
+        int nthreads = 8;
+        int opt, rv;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        memset(&l, 0, sizeof(l));
+        l.nticks = 5000;
+        l.perticks = 2;
+        l.tick_ns = 1000000;
+        l.rng = 0x9e3779b97f4a7c15ULL;
+
+        while ((opt = getopt(argc, argv, "n:k:t:j:d:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        l.nticks = strtoul(optarg, NULL, 10);
+                        break;
+                case 'k':
+                        l.perticks = strtoul(optarg, NULL, 10);
+                        break;
+                case 't':
+                        l.tick_ns = strtoul(optarg, NULL, 10) * 1000;
+                        break;
+                case 'j':
+                        nthreads = atoi(optarg);
+                        if (nthreads < 1 || nthreads > MAX_THREADS) {
+                                usage(basename(argv[0]));
+                                exit(3);
+                        }
+                        break;
+                case 'd':
+                        delay_us = strtoul(optarg, NULL, 10);
+                        break;
+                default:
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+        }
+
+        if (optind < argc - 1 || l.nticks == 0 || l.perticks == 0 ||
+            l.tick_ns == 0) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+        l.pwq = pwquality_default_settings();
+        if (l.pwq == NULL)
+                nomem();
+        if (optind < argc) {
+                if ((rv = pwquality_read_config(l.pwq, argv[optind], &auxerror)) != 0) {
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, rv, auxerror));
+                        exit(3);
+                }
+        }
+        /* the GECOS check does the slow passwd lookup */
+        pwquality_set_int_value(l.pwq, PWQ_SETTING_GECOS_CHECK, 1);
+
+        nchecks = l.nticks * l.perticks;
+        l.interval = calloc(l.nticks, sizeof(*l.interval));
+        l.latency = calloc(nchecks, sizeof(*l.latency));
+        l.submitted = calloc(nchecks, sizeof(*l.submitted));
+        if (l.interval == NULL || l.latency == NULL || l.submitted == NULL)
+                nomem();
+
+        printf("%-12s %10s %10s %10s %10s %10s %10s %9s\n", "mode",
+                "tick p50", "tick p99", "tick max", "check p50", "check p99",
+                "check max", "rejected");
+
+        run_loop(&l, NULL);
+        report("sync", l.interval, l.nticks, l.latency, nchecks, l.rejected);
+
+        async = pwquality_async_new(l.pwq, nthreads);
+        if (async == NULL)
+                nomem();
+        run_loop(&l, async);
+        pwquality_async_free(async);
+        snprintf(mode, sizeof(mode), "async -j %d", nthreads);
+        report(mode, l.interval, l.nticks, l.latency, nchecks, l.rejected);
+
+        free(l.interval);
+        free(l.latency);
+        free(l.submitted);
+        pwquality_free_settings(l.pwq);
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
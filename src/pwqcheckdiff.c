@@ -0,0 +1,702 @@
+/*
+ * pwqcheckdiff - a tool for comparing pwquality_check() with the
+ * reference implementation
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+#define MAX_THREADS      256
+#define MAX_LEN          256
+#define SETTINGS_PERIOD  4096 /* cases checked with the same settings */
+#define MAX_REPORTED     20   /* divergences printed in detail */
+#define NAME_INDEXES     4    /* built for the nameindex setting */
+#define MAX_NAMES        50   /* in each of them */
+
+enum { RANDOM, ADVERSARIAL, CORPUS, CATEGORIES };
+
+static const char *category_names[CATEGORIES] = {
+        "random", "adversarial", "corpus"
+};
+
+static const char *alphabets[] = {
+        "ab",
+        "abc123",
+        "aAbB1!",
+        "abcdefghijklmnopqrstuvwxyz",
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!@#$%^&*()-_=+[]{};:,.<>/?~ "
+};
+
+struct diff {
+        unsigned long long cases;
+        unsigned long long next;
+        unsigned long long divergences;
+        char **corpus;
+        size_t ncorpus;
+        unsigned long seed;
+        char tmpdir[32];
+        char *nameindex[NAME_INDEXES + 1]; /* the last one is never built */
+        char **names[NAME_INDEXES];
+        size_t nnames[NAME_INDEXES];
+        pthread_mutex_t lock;
+        /* per category: number of cases, time of each implementation */
+        unsigned long long count[CATEGORIES];
+        unsigned long long ref_ns[CATEGORIES];
+        unsigned long long opt_ns[CATEGORIES];
+};
+
+struct input {
+        char password[MAX_LEN + 1];
+        char old[MAX_LEN + 1];
+        char user[MAX_LEN + 1];
+        const char *p, *o, *u;
+};
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-n cases] [-j threads] [-s seed] [-c corpus]\n"), progname);
+        fprintf(stderr, _("       The command checks random, adversarial and corpus inputs with random\n"
+                          "       settings by pwquality_check() and by the reference implementation and\n"
+                          "       reports the cases where the results differ.\n"));
+}
+
+static uint64_t
+now_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t
+rnd(uint64_t *state, uint32_t n)
+{
+        /* splitmix64, the cases are reproducible from the seed */
+        uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        return n ? (uint32_t)((z >> 32) % n) : 0;
+}
+
+static void
+random_string(uint64_t *rng, char *buf, size_t len)
+{
+        const char *alphabet;
+        size_t i, n;
+
+        if (rnd(rng, 8) == 0) {
+                /* any byte but the terminator */
+                for (i = 0; i < len; i++)
+                        buf[i] = 1 + rnd(rng, 255);
+        } else {
+                alphabet = alphabets[rnd(rng, sizeof(alphabets) / sizeof(alphabets[0]))];
+                n = strlen(alphabet);
+                for (i = 0; i < len; i++)
+                        buf[i] = alphabet[rnd(rng, n)];
+        }
+        buf[len] = '\0';
+}
+
+static size_t
+random_len(uint64_t *rng)
+{
+        if (rnd(rng, 16) == 0)
+                return rnd(rng, MAX_LEN + 1);
+        return rnd(rng, 33);
+}
+
+/* copy src to dst with a few random insertions, deletions and changes */
+static void
+mutate(uint64_t *rng, char *dst, const char *src, int edits)
+{
+        size_t len = strlen(src);
+        int i;
+
+        memcpy(dst, src, len + 1);
+        for (i = 0; i < edits; i++) {
+                size_t pos = rnd(rng, len + 1);
+
+                switch (rnd(rng, 3)) {
+                case 0:
+                        if (len < MAX_LEN) {
+                                memmove(dst + pos + 1, dst + pos, len - pos + 1);
+                                dst[pos] = 'a' + rnd(rng, 26);
+                                ++len;
+                        }
+                        break;
+                case 1:
+                        if (pos < len) {
+                                memmove(dst + pos, dst + pos + 1, len - pos);
+                                --len;
+                        }
+                        break;
+                default:
+                        if (pos < len)
+                                dst[pos] = 'A' + rnd(rng, 26);
+                }
+        }
+}
+
+/* put the word (possibly reversed) into the buffer at a random position */
+static void
+embed(uint64_t *rng, char *buf, const char *word)
+{
+        size_t len = strlen(buf), wlen = strlen(word), pos, i;
+        int reverse = rnd(rng, 2);
+
+        if (wlen > len)
+                return;
+        pos = rnd(rng, len - wlen + 1);
+        for (i = 0; i < wlen; i++)
+                buf[pos + i] = reverse ? word[wlen - 1 - i] : word[i];
+}
+
+static void
+adversarial(uint64_t *rng, struct input *in)
+{
+        size_t len = random_len(rng), i, run;
+        char c;
+
+        random_string(rng, in->password, len);
+        random_string(rng, in->old, random_len(rng));
+        random_string(rng, in->user, rnd(rng, 12));
+
+        switch (rnd(rng, 10)) {
+        case 0: /* monotonic sequence */
+                run = rnd(rng, 10);
+                c = 32 + rnd(rng, 95);
+                for (i = 0; i < run && i < len; i++)
+                        in->password[i] = rnd(rng, 2) ? c + i : c - i;
+                break;
+        case 1: /* repeated characters */
+                run = rnd(rng, 10);
+                c = 'a' + rnd(rng, 26);
+                for (i = 0; i < run && i < len; i++)
+                        in->password[len - 1 - i] = c;
+                break;
+        case 2: /* palindrome */
+                for (i = 0; i < len / 2; i++)
+                        in->password[len - 1 - i] = rnd(rng, 8) ? in->password[i] :
+                                toupper((unsigned char)in->password[i]);
+                break;
+        case 3: /* old password with case changes */
+                for (i = 0; i < len; i++)
+                        in->old[i] = rnd(rng, 2) ? toupper((unsigned char)in->password[i]) :
+                                tolower((unsigned char)in->password[i]);
+                in->old[len] = '\0';
+                break;
+        case 4: /* rotated old password */
+                run = len ? rnd(rng, len) : 0;
+                memcpy(in->old, in->password + run, len - run);
+                memcpy(in->old + len - run, in->password, run);
+                in->old[len] = '\0';
+                break;
+        case 5: /* old password with a few edits */
+                mutate(rng, in->old, in->password, rnd(rng, 4));
+                break;
+        case 6: /* user name in the password */
+                mutate(rng, in->user, in->password + (len ? rnd(rng, len) : 0), rnd(rng, 2));
+                in->user[rnd(rng, 12)] = '\0';
+                embed(rng, in->password, in->user);
+                break;
+        case 7: /* long strings over a small alphabet */
+                len = MAX_LEN / 2 + rnd(rng, MAX_LEN / 2 + 1);
+                for (i = 0; i < len; i++)
+                        in->password[i] = "abAB12"[rnd(rng, 6)];
+                in->password[len] = '\0';
+                mutate(rng, in->old, in->password, rnd(rng, 8));
+                break;
+        case 8: /* chunk of the old password at another position */
+                run = rnd(rng, 12);
+                if (run > len)
+                        run = len;
+                i = strlen(in->old);
+                if (run <= i)
+                        memcpy(in->old + rnd(rng, i - run + 1),
+                                in->password + rnd(rng, len - run + 1), run);
+                break;
+        default: /* empty strings */
+                if (rnd(rng, 2))
+                        in->password[0] = '\0';
+                if (rnd(rng, 2))
+                        in->old[0] = '\0';
+                if (rnd(rng, 2))
+                        in->user[0] = '\0';
+        }
+}
+
+static void
+corpus(struct diff *d, uint64_t *rng, struct input *in)
+{
+        const char *line = d->corpus[rnd(rng, d->ncorpus)];
+
+        snprintf(in->password, sizeof(in->password), "%s", line);
+        if (rnd(rng, 2))
+                mutate(rng, in->old, in->password, rnd(rng, 4));
+        else
+                snprintf(in->old, sizeof(in->old), "%s", d->corpus[rnd(rng, d->ncorpus)]);
+        snprintf(in->user, sizeof(in->user), "%s", d->corpus[rnd(rng, d->ncorpus)]);
+        in->user[rnd(rng, 12)] = '\0';
+}
+
+static void
+make_input(struct diff *d, uint64_t *rng, int category, struct input *in)
+{
+        switch (category) {
+        case RANDOM:
+                random_string(rng, in->password, random_len(rng));
+                random_string(rng, in->old, random_len(rng));
+                random_string(rng, in->user, rnd(rng, 12));
+                break;
+        case ADVERSARIAL:
+                adversarial(rng, in);
+                break;
+        default:
+                corpus(d, rng, in);
+        }
+
+        in->p = rnd(rng, 64) ? in->password : NULL;
+        in->o = rnd(rng, 3) ? in->old : NULL;
+        switch (rnd(rng, 16)) {
+        case 0:
+                in->u = "root";
+                break;
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+                in->u = NULL;
+                break;
+        default:
+                in->u = in->user;
+        }
+}
+
+static void
+random_settings(struct diff *d, uint64_t *rng, pwquality_settings_t *pwq)
+{
+        char words[64];
+        size_t i;
+
+        pwquality_set_int_value(pwq, PWQ_SETTING_DIFF_OK, rnd(rng, 4) ? rnd(rng, 6) : rnd(rng, 20));
+        pwquality_set_int_value(pwq, PWQ_SETTING_MIN_LENGTH, rnd(rng, 24));
+        pwquality_set_int_value(pwq, PWQ_SETTING_DIG_CREDIT, (int)rnd(rng, 7) - 3);
+        pwquality_set_int_value(pwq, PWQ_SETTING_UP_CREDIT, (int)rnd(rng, 7) - 3);
+        pwquality_set_int_value(pwq, PWQ_SETTING_LOW_CREDIT, (int)rnd(rng, 7) - 3);
+        pwquality_set_int_value(pwq, PWQ_SETTING_OTH_CREDIT, (int)rnd(rng, 7) - 3);
+        pwquality_set_int_value(pwq, PWQ_SETTING_MIN_CLASS, rnd(rng, 5));
+        pwquality_set_int_value(pwq, PWQ_SETTING_MAX_REPEAT, rnd(rng, 6));
+        pwquality_set_int_value(pwq, PWQ_SETTING_MAX_CLASS_REPEAT, rnd(rng, 8));
+        pwquality_set_int_value(pwq, PWQ_SETTING_MAX_SEQUENCE, rnd(rng, 7));
+        pwquality_set_int_value(pwq, PWQ_SETTING_GECOS_CHECK, rnd(rng, 8) == 0);
+        pwquality_set_int_value(pwq, PWQ_SETTING_DICT_CHECK, rnd(rng, 8) == 0);
+        pwquality_set_int_value(pwq, PWQ_SETTING_USER_CHECK, rnd(rng, 4) != 0);
+        pwquality_set_int_value(pwq, PWQ_SETTING_USER_SUBSTR, rnd(rng, 2) ? 0 : rnd(rng, 9));
+        pwquality_set_int_value(pwq, PWQ_SETTING_OLD_SUBSTR, rnd(rng, 2) ? 0 : rnd(rng, 12));
+
+        if (rnd(rng, 2)) {
+                pwquality_set_str_value(pwq, PWQ_SETTING_BAD_WORDS, NULL);
+        } else {
+                random_string(rng, words, rnd(rng, sizeof(words)));
+                for (i = 0; words[i] != '\0'; i++)
+                        if (rnd(rng, 6) == 0)
+                                words[i] = ' ';
+                pwquality_set_str_value(pwq, PWQ_SETTING_BAD_WORDS, words);
+        }
+
+        i = rnd(rng, 4 * (NAME_INDEXES + 1));
+        pwquality_set_str_value(pwq, PWQ_SETTING_NAME_INDEX,
+                i <= NAME_INDEXES ? d->nameindex[i] : NULL);
+}
+
+static void
+print_string(const char *label, const char *s)
+{
+        printf("  %s: ", label);
+        if (s == NULL) {
+                printf("NULL\n");
+                return;
+        }
+        putchar('"');
+        for (; *s != '\0'; s++) {
+                if (*s == '"' || *s == '\\')
+                        printf("\\%c", *s);
+                else if (isprint((unsigned char)*s))
+                        putchar(*s);
+                else
+                        printf("\\x%02x", (unsigned char)*s);
+        }
+        printf("\"\n");
+}
+
+static void
+report(pwquality_settings_t *pwq, const struct input *in,
+        int ref, void *ref_aux, int opt, void *opt_aux)
+{
+        const char *words = NULL;
+
+        printf("Divergence: reference %d (aux %ld), optimized %d (aux %ld)\n",
+                ref, (long)ref_aux, opt, (long)opt_aux);
+        printf("  difok=%d minlen=%d dcredit=%d ucredit=%d lcredit=%d ocredit=%d"
+                " minclass=%d maxrepeat=%d maxclassrepeat=%d maxsequence=%d"
+                " gecoscheck=%d dictcheck=%d usercheck=%d usersubstr=%d"
+                " oldsubstr=%d\n",
+                pwq->diff_ok, pwq->min_length, pwq->dig_credit, pwq->up_credit,
+                pwq->low_credit, pwq->oth_credit, pwq->min_class,
+                pwq->max_repeat, pwq->max_class_repeat, pwq->max_sequence,
+                pwq->gecos_check, pwq->dict_check, pwq->user_check,
+                pwq->user_substr, pwq->old_substr);
+        (void)pwquality_get_str_value(pwq, PWQ_SETTING_BAD_WORDS, &words);
+        print_string("badwords", words);
+        print_string("nameindex", pwq->name_index);
+        print_string("password", in->p);
+        print_string("oldpassword", in->o);
+        print_string("user", in->u);
+}
+
+static int
+same_aux(int rv, void *a, void *b)
+{
+        if (rv == PWQ_ERROR_CRACKLIB_CHECK && a && b)
+                return strcmp(a, b) == 0;
+        return a == b;
+}
+
+static void *
+diff_thread(void *arg)
+{
+        struct diff *d = arg;
+        pwquality_settings_t *pwq;
+        unsigned long long count[CATEGORIES] = { 0 };
+        unsigned long long ref_ns[CATEGORIES] = { 0 };
+        unsigned long long opt_ns[CATEGORIES] = { 0 };
+        struct input in;
+        uint64_t rng;
+        int i;
+
+        pwq = pwquality_default_settings();
+        if (pwq == NULL) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+
+        for (;;) {
+                unsigned long long base, n;
+
+                pthread_mutex_lock(&d->lock);
+                base = d->next;
+                d->next += SETTINGS_PERIOD;
+                pthread_mutex_unlock(&d->lock);
+                if (base >= d->cases)
+                        break;
+
+                /* each block of cases depends on the seed only */
+                rng = d->seed ^ (base * 0xd1342543de82ef95ULL);
+                random_settings(d, &rng, pwq);
+
+                for (n = base; n < base + SETTINGS_PERIOD && n < d->cases; n++) {
+                        int category = rnd(&rng, d->ncorpus ? CATEGORIES : CORPUS);
+                        void *ref_aux, *opt_aux;
+                        uint64_t t0, t1, t2;
+                        int ref, opt;
+
+                        make_input(d, &rng, category, &in);
+
+                        /* alternate the order so neither gets the warm caches */
+                        if (n & 1) {
+                                t0 = now_ns();
+                                ref = pwquality_check_reference(pwq, in.p, in.o, in.u, &ref_aux);
+                                t1 = now_ns();
+                                opt = pwquality_check(pwq, in.p, in.o, in.u, &opt_aux);
+                                t2 = now_ns();
+                                ref_ns[category] += t1 - t0;
+                                opt_ns[category] += t2 - t1;
+                        } else {
+                                t0 = now_ns();
+                                opt = pwquality_check(pwq, in.p, in.o, in.u, &opt_aux);
+                                t1 = now_ns();
+                                ref = pwquality_check_reference(pwq, in.p, in.o, in.u, &ref_aux);
+                                t2 = now_ns();
+                                opt_ns[category] += t1 - t0;
+                                ref_ns[category] += t2 - t1;
+                        }
+                        ++count[category];
+
+                        if (ref != opt || !same_aux(ref, ref_aux, opt_aux)) {
+                                pthread_mutex_lock(&d->lock);
+                                if (d->divergences++ < MAX_REPORTED)
+                                        report(pwq, &in, ref, ref_aux, opt, opt_aux);
+                                pthread_mutex_unlock(&d->lock);
+                        }
+                }
+        }
+
+        pthread_mutex_lock(&d->lock);
+        for (i = 0; i < CATEGORIES; i++) {
+                d->count[i] += count[i];
+                d->ref_ns[i] += ref_ns[i];
+                d->opt_ns[i] += opt_ns[i];
+        }
+        pthread_mutex_unlock(&d->lock);
+
+        pwquality_free_settings(pwq);
+        return NULL;
+}
+
+static void
+read_corpus(struct diff *d, const char *fname)
+{
+        FILE *f;
+        char *line = NULL;
+        size_t linesize = 0, alloc = 0;
+        ssize_t len;
+
+        if ((f = fopen(fname, "r")) == NULL) {
+                fprintf(stderr, _("Error: Cannot open %s: %s\n"), fname, strerror(errno));
+                exit(3);
+        }
+
+        while ((len = getline(&line, &linesize, f)) != -1) {
+                if (len > 0 && line[len - 1] == '\n')
+                        line[--len] = '\0';
+                if (d->ncorpus == alloc) {
+                        alloc = alloc ? alloc * 2 : 1024;
+                        d->corpus = realloc(d->corpus, alloc * sizeof(*d->corpus));
+                        if (d->corpus == NULL) {
+                                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                                exit(2);
+                        }
+                }
+                if ((d->corpus[d->ncorpus++] = strdup(line)) == NULL) {
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                        exit(2);
+                }
+        }
+        free(line);
+        fclose(f);
+}
+
+static void
+out_of_memory(void)
+{
+        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+        exit(2);
+}
+
+/* build a few small indexes of random names and give the names to the
+   reference, which searches for them naively */
+static void
+build_name_indexes(struct diff *d)
+{
+        static const char *name_alphabets[] = {
+                "ab", "abc1", "abcdefghijklmnopqrstuvwxyz0123456789"
+        };
+        uint64_t rng = d->seed;
+        size_t i, j, k, len;
+
+        snprintf(d->tmpdir, sizeof(d->tmpdir), "/tmp/pwqcheckdiff.XXXXXX");
+        if (mkdtemp(d->tmpdir) == NULL) {
+                fprintf(stderr, _("Error: Cannot create %s: %s\n"), d->tmpdir, strerror(errno));
+                exit(2);
+        }
+
+        for (i = 0; i <= NAME_INDEXES; i++) {
+                struct pwq_names_list l = { NULL, 0, 0 };
+                const char *alphabet;
+                char name[16];
+
+                if (asprintf(&d->nameindex[i], "%s/names%zu", d->tmpdir, i) < 0)
+                        out_of_memory();
+                if (i == NAME_INDEXES) {
+                        pwquality_reference_names(d->nameindex[i], NULL, 0);
+                        break;
+                }
+
+                alphabet = name_alphabets[rnd(&rng, sizeof(name_alphabets) / sizeof(name_alphabets[0]))];
+                d->nnames[i] = 1 + rnd(&rng, MAX_NAMES);
+                if ((d->names[i] = calloc(d->nnames[i], sizeof(char *))) == NULL)
+                        out_of_memory();
+                for (j = 0; j < d->nnames[i]; j++) {
+                        /* the short ones are ignored by both */
+                        len = (j ? 3 : PWQ_MIN_WORD_LENGTH) + rnd(&rng, 5);
+                        for (k = 0; k < len; k++)
+                                name[k] = alphabet[rnd(&rng, strlen(alphabet))];
+                        name[len] = '\0';
+                        if ((d->names[i][j] = strdup(name)) == NULL ||
+                            names_list_add(&l, name, len) < 0)
+                                out_of_memory();
+                }
+
+                if (names_list_finish(&l) < 0)
+                        out_of_memory();
+                if (names_index_write(&l, names_list_digest(&l), d->nameindex[i], NULL) < 0) {
+                        if (errno == ENOMEM)
+                                out_of_memory();
+                        fprintf(stderr, _("Error: Cannot write %s: %s\n"), d->nameindex[i], strerror(errno));
+                        exit(2);
+                }
+                names_list_free(&l);
+                pwquality_reference_names(d->nameindex[i], d->names[i], d->nnames[i]);
+        }
+}
+
+static void
+remove_name_indexes(struct diff *d)
+{
+        size_t i, j;
+
+        for (i = 0; i <= NAME_INDEXES; i++) {
+                unlink(d->nameindex[i]);
+                free(d->nameindex[i]);
+                if (i == NAME_INDEXES)
+                        break;
+                for (j = 0; j < d->nnames[i]; j++)
+                        free(d->names[i][j]);
+                free(d->names[i]);
+        }
+        rmdir(d->tmpdir);
+}
+
+/* compare the implementations */
+int
+main(int argc, char *argv[])
+{
+        struct diff d;
+        pthread_t threads[MAX_THREADS];
+        unsigned long long total = 0, ref_total = 0, opt_total = 0;
+        long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+        uint64_t start;
+        size_t i;
+        int opt;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        memset(&d, 0, sizeof(d));
+        d.cases = 1000000;
+        d.seed = time(NULL);
+
+        while ((opt = getopt(argc, argv, "n:j:s:c:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        d.cases = strtoull(optarg, NULL, 10);
+                        break;
+                case 'j':
+                        nthreads = atol(optarg);
+                        break;
+                case 's':
+                        d.seed = strtoul(optarg, NULL, 10);
+                        break;
+                case 'c':
+                        read_corpus(&d, optarg);
+                        break;
+                default:
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+        }
+
+        if (optind != argc || nthreads < 1 || nthreads > MAX_THREADS) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+        printf(_("Comparing %llu checks with seed %lu in %ld threads\n"),
+                d.cases, d.seed, nthreads);
+        fflush(stdout);
+
+        build_name_indexes(&d);
+
+        pthread_mutex_init(&d.lock, NULL);
+        start = now_ns();
+        for (i = 0; i < (size_t)nthreads; i++) {
+                if (pthread_create(&threads[i], NULL, diff_thread, &d) != 0) {
+                        fprintf(stderr, _("Error: Cannot start the threads\n"));
+                        exit(2);
+                }
+        }
+        for (i = 0; i < (size_t)nthreads; i++)
+                pthread_join(threads[i], NULL);
+
+        for (i = 0; i < CATEGORIES; i++) {
+                if (d.count[i] == 0)
+                        continue;
+                printf(_("%-12s %12llu checks, reference %8.0f ns, optimized %8.0f ns, speedup %.2f\n"),
+                        category_names[i], d.count[i],
+                        (double)d.ref_ns[i] / d.count[i],
+                        (double)d.opt_ns[i] / d.count[i],
+                        d.opt_ns[i] ? (double)d.ref_ns[i] / d.opt_ns[i] : 0.0);
+                total += d.count[i];
+                ref_total += d.ref_ns[i];
+                opt_total += d.opt_ns[i];
+        }
+        printf(_("%-12s %12llu checks, reference %8.0f ns, optimized %8.0f ns, speedup %.2f\n"),
+                _("total"), total, (double)ref_total / total,
+                (double)opt_total / total,
+                opt_total ? (double)ref_total / opt_total : 0.0);
+        printf(_("%llu divergences found in %.1f seconds\n"), d.divergences,
+                (now_ns() - start) / 1e9);
+
+        pthread_mutex_destroy(&d.lock);
+        remove_name_indexes(&d);
+        for (i = 0; i < d.ncorpus; i++)
+                free(d.corpus[i]);
+        free(d.corpus);
+
+        return d.divergences ? 1 : 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
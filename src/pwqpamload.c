@@ -0,0 +1,587 @@
+/*
+ * pwqpamload - a load test of the pam_pwquality module
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <security/pam_appl.h>
+
+#include "pwquality.h"
+
+#define MAX_THREADS 256
+#define SERVICE "pwqpamload"
+#define STUB_PROMPT "Current password: " /* as in pwqpamstub.c */
+
+#ifndef HAVE_PAM_START_CONFDIR
+/* Linux-PAM before 1.4 reads the service files only from /etc/pam.d,
+   main() refuses to run then */
+#define pam_start_confdir(_service, _user, _conv, _confdir, _pamh) \
+        pam_start(_service, _user, _conv, _pamh)
+#endif
+
+struct input {
+        char *user;
+        char *password;
+        char *oldpassword;
+};
+
+struct load {
+        const char *confdir;
+        const char *stub;
+        struct input *inputs;
+        size_t ninputs;
+        size_t ntrans;
+        size_t next;
+        uint32_t *latency;
+        unsigned long rejected;
+        unsigned long failed;
+};
+
+/* the answers of the scripted conversation of one transaction */
+struct script {
+        const char *password;
+        const char *oldpassword;
+        int rejected;
+};
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-n transactions] [-j threads] [-d delay-us] [-p users]\n"
+                          "       [-m module] [-i input] <config>[:<module-args>]...\n"), progname);
+        fprintf(stderr, _("       The command runs concurrent PAM password changes through pam_pwquality\n"
+                          "       with each pwquality.conf given and reports their throughput and latency.\n"
+                          "       It must be run with the pwqpamstub.so library in LD_PRELOAD.\n"));
+}
+
+static uint64_t
+now_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t
+rnd(uint64_t *state, uint32_t n)
+{
+        /* xorshift64*, the inputs need not be unpredictable */
+        *state ^= *state >> 12;
+        *state ^= *state << 25;
+        *state ^= *state >> 27;
+        return ((*state * 0x2545F4914F6CDD1DULL) >> 32) % n;
+}
+
+static void
+nomem(void)
+{
+        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+        exit(2);
+}
+
+static char *
+xstrdup(const char *s)
+{
+        char *p = strdup(s);
+
+        if (p == NULL)
+                nomem();
+        return p;
+}
+
+static int
+conversation(int num_msg, const struct pam_message **msg,
+        struct pam_response **resp, void *appdata_ptr)
+{
+        struct script *script = appdata_ptr;
+        struct pam_response *reply;
+        int i;
+
+        reply = calloc(num_msg, sizeof(*reply));
+        if (reply == NULL)
+                return PAM_BUF_ERR;
+
+        for (i = 0; i < num_msg; i++) {
+                switch (msg[i]->msg_style) {
+                case PAM_PROMPT_ECHO_OFF:
+                case PAM_PROMPT_ECHO_ON:
+                        /* the stub asks for the current password first,
+                           pam_pwquality for the new one twice */
+                        if (strcmp(msg[i]->msg, STUB_PROMPT) == 0)
+                                reply[i].resp = strdup(script->oldpassword ?
+                                        script->oldpassword : "");
+                        else
+                                reply[i].resp = strdup(script->password);
+                        if (reply[i].resp == NULL)
+                                goto fail;
+                        break;
+                case PAM_ERROR_MSG:
+                        /* BAD PASSWORD: ... */
+                        script->rejected = 1;
+                        break;
+                default:
+                        break;
+                }
+        }
+        *resp = reply;
+        return PAM_SUCCESS;
+
+fail:
+        for (i = 0; i < num_msg; i++)
+                free(reply[i].resp);
+        free(reply);
+        return PAM_BUF_ERR;
+}
+
+static void *
+load_thread(void *arg)
+{
+        struct load *l = arg;
+        unsigned long rejected = 0, failed = 0;
+
+        for (;;) {
+                struct script script;
+                struct pam_conv conv = { conversation, &script };
+                const struct input *in;
+                pam_handle_t *pamh = NULL;
+                uint64_t start, t;
+                size_t i;
+                int rv;
+
+                i = __atomic_fetch_add(&l->next, 1, __ATOMIC_RELAXED);
+                if (i >= l->ntrans)
+                        break;
+                in = &l->inputs[i % l->ninputs];
+                script.password = in->password;
+                script.oldpassword = in->oldpassword;
+                script.rejected = 0;
+
+                /* the whole transaction as seen by passwd */
+                start = now_ns();
+                rv = pam_start_confdir(SERVICE, in->user, &conv, l->confdir, &pamh);
+                if (rv == PAM_SUCCESS)
+                        rv = pam_chauthtok(pamh, 0);
+                if (pamh)
+                        pam_end(pamh, rv);
+                t = now_ns() - start;
+                l->latency[i] = t > UINT32_MAX ? UINT32_MAX : t;
+
+                if (script.rejected)
+                        ++rejected;
+                else if (rv != PAM_SUCCESS)
+                        ++failed;
+        }
+
+        __atomic_add_fetch(&l->rejected, rejected, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&l->failed, failed, __ATOMIC_RELAXED);
+        return NULL;
+}
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+        uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+        return x < y ? -1 : x > y;
+}
+
+/* read the lines of the form [user<TAB>]password[<TAB>oldpassword] */
+static struct input *
+read_inputs(const char *fname, size_t *ninputs)
+{
+        struct input *inputs = NULL;
+        size_t n = 0, alloc = 0, linesize = 0;
+        char *line = NULL, *tab;
+        ssize_t len;
+        FILE *f;
+
+        if ((f = fopen(fname, "r")) == NULL) {
+                fprintf(stderr, _("Error: Cannot open %s: %s\n"), fname, strerror(errno));
+                exit(3);
+        }
+
+        while ((len = getline(&line, &linesize, f)) != -1) {
+                struct input *in;
+
+                if (len > 0 && line[len - 1] == '\n')
+                        line[--len] = '\0';
+                if (n == alloc) {
+                        alloc = alloc ? alloc * 2 : 1024;
+                        inputs = realloc(inputs, alloc * sizeof(*inputs));
+                        if (inputs == NULL)
+                                nomem();
+                }
+                in = &inputs[n++];
+                in->user = "pwqload";
+                in->password = line;
+                in->oldpassword = NULL;
+                if ((tab = strchr(line, '\t')) != NULL) {
+                        *tab = '\0';
+                        in->user = line;
+                        in->password = tab + 1;
+                        if ((tab = strchr(in->password, '\t')) != NULL) {
+                                *tab = '\0';
+                                in->oldpassword = xstrdup(tab + 1);
+                        }
+                }
+                in->user = xstrdup(in->user);
+                in->password = xstrdup(in->password);
+        }
+        fclose(f);
+        free(line);
+
+        *ninputs = n;
+        return inputs;
+}
+
+/* random passwords of mixed quality for 100 users */
+static struct input *
+make_inputs(size_t *ninputs)
+{
+        static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%";
+        uint64_t rng = 0x9e3779b97f4a7c15ULL;
+        struct input *inputs;
+        char buf[32];
+        size_t i, j, len;
+
+        *ninputs = 4096;
+        inputs = calloc(*ninputs, sizeof(*inputs));
+        if (inputs == NULL)
+                nomem();
+        for (i = 0; i < *ninputs; i++) {
+                snprintf(buf, sizeof(buf), "pwqload%zu", i % 100);
+                inputs[i].user = xstrdup(buf);
+                len = 6 + rnd(&rng, 12);
+                for (j = 0; j < len; j++)
+                        buf[j] = chars[rnd(&rng, rnd(&rng, 2) ? 26 : sizeof(chars) - 1)];
+                buf[len] = '\0';
+                inputs[i].password = xstrdup(buf);
+                for (j = 0; j < 8; j++)
+                        buf[j] = chars[rnd(&rng, sizeof(chars) - 1)];
+                buf[8] = '\0';
+                inputs[i].oldpassword = xstrdup(buf);
+        }
+        return inputs;
+}
+
+static void
+write_file(const char *dir, const char *name, const char *contents)
+{
+        char path[PATH_MAX];
+        FILE *f;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if ((f = fopen(path, "w")) == NULL ||
+            fputs(contents, f) == EOF ||
+            fclose(f) != 0) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), path, strerror(errno));
+                exit(1);
+        }
+}
+
+static void
+copy_file(const char *dir, const char *name, const char *src)
+{
+        char path[PATH_MAX], buf[4096];
+        FILE *in, *out;
+        size_t n;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if ((in = fopen(src, "r")) == NULL) {
+                fprintf(stderr, _("Error: Cannot open %s: %s\n"), src, strerror(errno));
+                exit(3);
+        }
+        if ((out = fopen(path, "w")) == NULL) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), path, strerror(errno));
+                exit(1);
+        }
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+                fwrite(buf, 1, n, out);
+        fclose(in);
+        if (fclose(out) != 0) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), path, strerror(errno));
+                exit(1);
+        }
+}
+
+/* The users whose names start with "remote" are left out so that
+ * local_users_only skips them, the fillers go first to make the
+ * scan of the file as long as on a system with many local users. */
+static void
+write_passwd(const char *dir, const struct input *inputs, size_t ninputs,
+        int fillers)
+{
+        char path[PATH_MAX];
+        FILE *f;
+        size_t i, j;
+        int k;
+
+        snprintf(path, sizeof(path), "%s/etc/passwd", dir);
+        if ((f = fopen(path, "w")) == NULL) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), path, strerror(errno));
+                exit(1);
+        }
+        for (k = 0; k < fillers; k++)
+                fprintf(f, "filler%d:x:%d:100::/nonexistent:/bin/sh\n", k, 10000 + k);
+        for (i = 0; i < ninputs; i++) {
+                if (strncmp(inputs[i].user, "remote", 6) == 0)
+                        continue;
+                for (j = 0; j < i && strcmp(inputs[j].user, inputs[i].user) != 0; j++)
+                        ;
+                if (j == i)
+                        fprintf(f, "%s:x:%zu:100:Load Test User:/nonexistent:/bin/sh\n",
+                                inputs[i].user, 1000 + i);
+        }
+        if (fclose(f) != 0) {
+                fprintf(stderr, _("Error: Cannot write %s: %s\n"), path, strerror(errno));
+                exit(1);
+        }
+}
+
+static void
+make_dir(const char *dir, const char *name)
+{
+        char path[PATH_MAX];
+
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (mkdir(path, 0700) == -1 && errno != EEXIST) {
+                fprintf(stderr, _("Error: Cannot create %s: %s\n"), path, strerror(errno));
+                exit(1);
+        }
+}
+
+static void
+run_config(struct load *l, const char *tmpdir, const char *module,
+        const char *spec, int nthreads)
+{
+        pthread_t threads[MAX_THREADS];
+        char *conf, *args, *service;
+        uint32_t *v = l->latency;
+        size_t n = l->ntrans;
+        uint64_t start, span;
+        int i;
+
+        conf = xstrdup(spec);
+        args = strchr(conf, ':');
+        if (args)
+                *args++ = '\0';
+
+        if (*conf)
+                copy_file(tmpdir, "etc/security/pwquality.conf", conf);
+        else
+                write_file(tmpdir, "etc/security/pwquality.conf", "");
+        if (asprintf(&service, "password requisite %s\n"
+                     "password requisite %s %s\n"
+                     "password required pam_permit.so\n",
+                     l->stub, module, args ? args : "") < 0)
+                nomem();
+        write_file(tmpdir, "pam.d/" SERVICE, service);
+        free(service);
+
+        l->next = 0;
+        l->rejected = l->failed = 0;
+        start = now_ns();
+        for (i = 0; i < nthreads; i++) {
+                if (pthread_create(&threads[i], NULL, load_thread, l) != 0) {
+                        fprintf(stderr, _("Error: Cannot start the load threads\n"));
+                        exit(2);
+                }
+        }
+        for (i = 0; i < nthreads; i++)
+                pthread_join(threads[i], NULL);
+        span = now_ns() - start;
+
+        qsort(v, n, sizeof(*v), cmp_u32);
+        printf("%-24s %10.0f %10.1f %10.1f %10.1f %10.1f %10.1f %9lu %7lu\n",
+                spec, n / (span / 1e9),
+                v[n / 2] / 1e3, v[n * 9 / 10] / 1e3, v[n * 99 / 100] / 1e3,
+                v[n * 999 / 1000] / 1e3, v[n - 1] / 1e3,
+                l->rejected, l->failed);
+        fflush(stdout);
+        free(conf);
+}
+
+static void
+remove_tree(const char *tmpdir)
+{
+        static const char *const files[] = {
+                "pam.d/" SERVICE, "pam.d", "etc/security/pwquality.conf",
+                "etc/security/pwquality.conf.d", "etc/security", "etc/passwd",
+                "etc", ""
+        };
+        char path[PATH_MAX];
+        size_t i;
+
+        for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+                snprintf(path, sizeof(path), "%s/%s", tmpdir, files[i]);
+                remove(path);
+        }
+}
+
+/* run the PAM password changes */
+int
+main(int argc, char *argv[])
+{
+        struct load l;
+        char tmpdir[] = "/tmp/pwqpamload.XXXXXX";
+        char confdir[PATH_MAX];
+        const char *module = NULL, *input = NULL;
+        char *mod = NULL, *stub = NULL;
+        Dl_info info;
+        void *loaded;
+        int nthreads = 1, fillers = 0;
+        int i, opt;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        memset(&l, 0, sizeof(l));
+        l.ntrans = 10000;
+
+        while ((opt = getopt(argc, argv, "n:j:d:p:m:i:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        l.ntrans = strtoul(optarg, NULL, 10);
+                        break;
+                case 'j':
+                        nthreads = atoi(optarg);
+                        if (nthreads < 1 || nthreads > MAX_THREADS) {
+                                usage(basename(argv[0]));
+                                exit(3);
+                        }
+                        break;
+                case 'd':
+                        setenv("PWQ_STUB_DELAY_US", optarg, 1);
+                        break;
+                case 'p':
+                        fillers = atoi(optarg);
+                        break;
+                case 'm':
+                        module = optarg;
+                        break;
+                case 'i':
+                        input = optarg;
+                        break;
+                default:
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+        }
+
+        if (optind == argc || l.ntrans == 0) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+#ifndef HAVE_PAM_START_CONFDIR
+        fprintf(stderr, _("Error: The PAM library does not support pam_start_confdir()\n"));
+        exit(3);
+#endif
+        if ((loaded = dlsym(RTLD_DEFAULT, "pwqpamstub_loaded")) == NULL) {
+                fprintf(stderr, _("Error: The pwqpamstub.so library is not preloaded\n"));
+                exit(3);
+        }
+        /* the preloaded stub is stacked as the module supplying the
+           current password, libpam gets the already loaded copy */
+        if (dladdr(loaded, &info) == 0 || info.dli_fname == NULL ||
+            (stub = realpath(info.dli_fname, NULL)) == NULL) {
+                fprintf(stderr, _("Error: Cannot find the path of the pwqpamstub.so library\n"));
+                exit(3);
+        }
+        l.stub = stub;
+
+        /* the module path in the service file must be absolute */
+        if (module == NULL)
+                module = ".libs/pam_pwquality.so";
+        if ((mod = realpath(module, NULL)) == NULL) {
+                fprintf(stderr, _("Error: Cannot open %s: %s\n"), module, strerror(errno));
+                exit(3);
+        }
+
+        l.inputs = input ? read_inputs(input, &l.ninputs) : make_inputs(&l.ninputs);
+        if (l.ninputs == 0) {
+                fprintf(stderr, _("Error: No passwords found in %s\n"), input);
+                exit(3);
+        }
+        l.latency = calloc(l.ntrans, sizeof(*l.latency));
+        if (l.latency == NULL)
+                nomem();
+
+        if (mkdtemp(tmpdir) == NULL) {
+                fprintf(stderr, _("Error: Cannot create %s: %s\n"), tmpdir, strerror(errno));
+                exit(1);
+        }
+        make_dir(tmpdir, "pam.d");
+        make_dir(tmpdir, "etc");
+        make_dir(tmpdir, "etc/security");
+        make_dir(tmpdir, "etc/security/pwquality.conf.d");
+        write_passwd(tmpdir, l.inputs, l.ninputs, fillers);
+        snprintf(confdir, sizeof(confdir), "%s/pam.d", tmpdir);
+        l.confdir = confdir;
+        setenv("PWQ_STUB_ROOT", tmpdir, 1);
+
+        printf("%-24s %10s %10s %10s %10s %10s %10s %9s %7s\n", "config",
+                "trans/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us",
+                "rejected", "failed");
+        for (i = optind; i < argc; i++)
+                run_config(&l, tmpdir, mod, argv[i], nthreads);
+
+        remove_tree(tmpdir);
+        free(l.latency);
+        free(mod);
+        free(stub);
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
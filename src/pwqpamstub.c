@@ -0,0 +1,261 @@
+/*
+ * pwqpamstub - LD_PRELOAD stub for pwqpamload
+ *
+ * It answers the passwd lookups of the NSS with synthetic entries after
+ * a configurable delay and redirects the opening of the pwquality
+ * configuration and of /etc/passwd into a temporary tree. It is also the
+ * module asking for the current password before pam_pwquality.
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pwd.h>
+#include <time.h>
+
+#define PAM_SM_PASSWORD
+
+#include <security/pam_modules.h>
+#include <security/pam_ext.h>
+
+/* PWQ_STUB_ROOT        directory prepended to the redirected paths
+ * PWQ_STUB_DELAY_US    delay of every passwd lookup in microseconds
+ * PWQ_STUB_GECOS       GECOS field of the synthetic entries
+ * PWQ_STUB_USERS       number of users user0, user1, ... enumerated by
+ *                      getpwent(), delayed once per PWQ_STUB_PAGE users
+ * The users whose names start with PWQ_STUB_MISSING do not exist. */
+#define PWQ_STUB_MISSING "unknown"
+#define PWQ_STUB_GECOS   "Load Test User,Room 101,555-0100"
+#define PWQ_STUB_PAGE    1000
+#define PWQ_STUB_PROMPT  "Current password: " /* as in pwqpamload.c */
+
+#ifndef PWQUALITY_DEFAULT_CFGFILE
+#define PWQUALITY_DEFAULT_CFGFILE "/etc/security/pwquality.conf"
+#endif
+
+/* pwqpamload refuses to run without the stub */
+int pwqpamstub_loaded = 1;
+
+static const char *
+redirect(const char *path, char *buf, size_t len)
+{
+        const char *root = getenv("PWQ_STUB_ROOT");
+
+        if (root == NULL || path == NULL)
+                return path;
+        if (strcmp(path, "/etc/passwd") != 0 &&
+            strncmp(path, PWQUALITY_DEFAULT_CFGFILE, strlen(PWQUALITY_DEFAULT_CFGFILE)) != 0)
+                return path;
+        if ((size_t)snprintf(buf, len, "%s%s", root, path) >= len)
+                return path;
+        return buf;
+}
+
+FILE *
+fopen(const char *path, const char *mode)
+{
+        static FILE *(*real_fopen)(const char *, const char *);
+        char buf[PATH_MAX];
+
+        if (real_fopen == NULL)
+                real_fopen = dlsym(RTLD_NEXT, "fopen");
+        return real_fopen(redirect(path, buf, sizeof(buf)), mode);
+}
+
+FILE *
+fopen64(const char *path, const char *mode)
+{
+        static FILE *(*real_fopen64)(const char *, const char *);
+        char buf[PATH_MAX];
+
+        if (real_fopen64 == NULL)
+                real_fopen64 = dlsym(RTLD_NEXT, "fopen64");
+        return real_fopen64(redirect(path, buf, sizeof(buf)), mode);
+}
+
+int
+scandir(const char *dir, struct dirent ***namelist,
+        int (*filter)(const struct dirent *),
+        int (*compar)(const struct dirent **, const struct dirent **))
+{
+        static int (*real_scandir)(const char *, struct dirent ***,
+                int (*)(const struct dirent *),
+                int (*)(const struct dirent **, const struct dirent **));
+        char buf[PATH_MAX];
+
+        if (real_scandir == NULL)
+                real_scandir = dlsym(RTLD_NEXT, "scandir");
+        return real_scandir(redirect(dir, buf, sizeof(buf)), namelist, filter, compar);
+}
+
+static void
+delay(void)
+{
+        const char *env = getenv("PWQ_STUB_DELAY_US");
+        long us = env ? atol(env) : 0;
+        struct timespec ts;
+
+        if (us <= 0)
+                return;
+        ts.tv_sec = us / 1000000;
+        ts.tv_nsec = us % 1000000 * 1000;
+        while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+                ;
+}
+
+/* copy the string into the buffer and return it or NULL if it does not fit */
+static char *
+put(char **buf, size_t *len, const char *s)
+{
+        size_t n = strlen(s) + 1;
+        char *p = *buf;
+
+        if (n > *len)
+                return NULL;
+        memcpy(p, s, n);
+        *buf += n;
+        *len -= n;
+        return p;
+}
+
+/* fill in the synthetic entry of the user */
+static int
+entry(const char *name, struct passwd *pwd, char *buf, size_t buflen,
+        struct passwd **result)
+{
+        const char *gecos = getenv("PWQ_STUB_GECOS");
+        unsigned int uid = 1000;
+        const char *p;
+
+        *result = NULL;
+        if (strncmp(name, PWQ_STUB_MISSING, strlen(PWQ_STUB_MISSING)) == 0)
+                return 0;
+
+        for (p = name; *p != '\0'; p++)
+                uid = uid * 31 + (unsigned char)*p;
+        pwd->pw_uid = 1000 + uid % 60000;
+        pwd->pw_gid = 100;
+        if ((pwd->pw_name = put(&buf, &buflen, name)) == NULL ||
+            (pwd->pw_passwd = put(&buf, &buflen, "x")) == NULL ||
+            (pwd->pw_gecos = put(&buf, &buflen, gecos ? gecos : PWQ_STUB_GECOS)) == NULL ||
+            (pwd->pw_dir = put(&buf, &buflen, "/nonexistent")) == NULL ||
+            (pwd->pw_shell = put(&buf, &buflen, "/bin/sh")) == NULL)
+                return ERANGE;
+        *result = pwd;
+        return 0;
+}
+
+int
+getpwnam_r(const char *name, struct passwd *pwd, char *buf, size_t buflen,
+        struct passwd **result)
+{
+        delay();
+        return entry(name, pwd, buf, buflen, result);
+}
+
+struct passwd *
+getpwnam(const char *name)
+{
+        static __thread struct passwd pwd;
+        static __thread char buf[1024];
+        struct passwd *result;
+
+        errno = getpwnam_r(name, &pwd, buf, sizeof(buf), &result);
+        return result;
+}
+
+static long enumerated;
+
+void
+setpwent(void)
+{
+        enumerated = 0;
+}
+
+void
+endpwent(void)
+{
+        enumerated = 0;
+}
+
+struct passwd *
+getpwent(void)
+{
+        static struct passwd pwd;
+        static char buf[1024];
+        const char *env = getenv("PWQ_STUB_USERS");
+        struct passwd *result;
+        char name[32];
+
+        if (env == NULL || enumerated >= atol(env))
+                return NULL;
+        /* the directory returns the entries in pages */
+        if (enumerated % PWQ_STUB_PAGE == 0)
+                delay();
+        snprintf(name, sizeof(name), "user%ld", enumerated++);
+        errno = entry(name, &pwd, buf, sizeof(buf), &result);
+        return result;
+}
+
+/* Only the modules may set PAM_OLDAUTHTOK, so the stub is stacked before
+ * pam_pwquality and asks for the current password in the preliminary check
+ * as pam_unix does. An empty answer leaves it unset. */
+PAM_EXTERN int
+pam_sm_chauthtok(pam_handle_t *pamh, int flags, int argc, const char **argv)
+{
+        char *resp = NULL;
+        int rv;
+
+        if (!(flags & PAM_PRELIM_CHECK))
+                return PAM_SUCCESS;
+
+        rv = pam_prompt(pamh, PAM_PROMPT_ECHO_OFF, &resp, "%s", PWQ_STUB_PROMPT);
+        if (rv == PAM_SUCCESS && resp && *resp)
+                rv = pam_set_item(pamh, PAM_OLDAUTHTOK, resp);
+        if (resp) {
+                memset(resp, 0, strlen(resp));
+                free(resp);
+        }
+        return rv;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -10,8 +10,39 @@
 #ifndef PWQPRIVATE_H
 #define PWQPRIVATE_H
 
+#include <stdint.h>
+#ifdef HAVE_CRACK_H
+#include <pthread.h>
+#endif
+
 #include "pwquality.h"
 
+#define PWQ_DICT_FILES           3 /* .pwd, .pwi, and .hwm */
+#define PWQ_DICT_SUFFIXES        { ".pwd", ".pwi", ".hwm" }
+
+struct pwq_dict_map {
+        void *addr;
+        size_t len;
+};
+
+/* The dictionary kept in memory by the preloading. It is shared by the
+ * copies of the settings until one of them changes the dictionary or the
+ * preloading and freed with the last one. */
+struct pwq_dict_state {
+        long refs;
+        int preloaded;           /* PWQ_DICT_PRELOADED_* */
+        int preload_failures;
+        struct pwq_dict_map maps[PWQ_DICT_FILES];
+};
+
+struct pwq_names_map;
+
+/* The index of names mapped by the first check, shared the same way. */
+struct pwq_names_ref {
+        long refs;
+        struct pwq_names_map *map;
+};
+
 struct pwquality_settings {
         int diff_ok;
         int min_length;
@@ -27,14 +58,33 @@ struct pwquality_settings {
         int dict_check;
         int user_check;
         int user_substr;
+        int old_substr;
         int enforcing;
         int retry_times;
         int enforce_for_root;
         int local_users_only;
+        int dict_preload;
+        struct pwq_dict_state *dict;
         char *bad_words;
         char *dict_path;
+        char *gen_model;
+        char *capture_file;
+        int capture_fd;
+        char *name_index;
+        struct pwq_names_ref *names;
 };
 
+/* The settings used by the check are read through PWQ_CHECK_SETTING so
+ * that builds configured with --with-fixed-policy fold them as the
+ * constants generated into pwqpolicy.h and the compiler can drop the
+ * disabled checks. */
+#ifdef PWQ_FIXED_POLICY
+#include "pwqpolicy.h"
+#define PWQ_CHECK_SETTING(_pwq, _field) (PWQ_POLICY_##_field)
+#else
+#define PWQ_CHECK_SETTING(_pwq, _field) ((_pwq)->_field)
+#endif
+
 struct setting_mapping {
         const char *name;
         int id;
@@ -56,10 +106,22 @@ struct setting_mapping {
 
 #define PWQ_DEFAULT_USER_CHECK   1
 #define PWQ_DEFAULT_USER_SUBSTR  0
+#define PWQ_DEFAULT_OLD_SUBSTR   0
 #define PWQ_DEFAULT_ENFORCING    1
 #define PWQ_DEFAULT_RETRY_TIMES  1
 #define PWQ_DEFAULT_ENFORCE_ROOT 0
 #define PWQ_DEFAULT_LOCAL_USERS  0
+#define PWQ_DEFAULT_DICT_PRELOAD 0
+
+#define PWQ_DICT_PRELOAD_FAULT   1 /* read the dictionary into the page cache */
+#define PWQ_DICT_PRELOAD_LOCK    2 /* and keep it mapped and locked */
+
+/* the preloading by the dictionary checks is retried after a failure
+ * until it succeeds or fails PWQ_DICT_PRELOAD_TRIES times */
+#define PWQ_DICT_PRELOADED_NO    0
+#define PWQ_DICT_PRELOADED_BUSY  1
+#define PWQ_DICT_PRELOADED_YES   2
+#define PWQ_DICT_PRELOAD_TRIES   3
 
 #define PWQ_TYPE_INT             1
 #define PWQ_TYPE_STR             2
@@ -71,6 +133,292 @@ struct setting_mapping {
 #define PWQ_MIN_WORD_LENGTH      4
 #define PWQ_MAX_PASSWD_BUF_LEN   16300
 
+/* Character transition model used by pwquality_generate() when the
+ * genmodel setting points to a file created by pwmkmodel.
+ * The model is of the second order over the lowercase letters, the state
+ * is given by the two previously generated characters with 0 standing for
+ * the word boundary. Each state holds a Walker alias table of
+ * PWQ_MODEL_COLUMNS columns so that a character is drawn with
+ * PWQ_MODEL_COLUMN_BITS + PWQ_MODEL_PROB_BITS random bits. */
+#define PWQ_MODEL_MAGIC          "PWQM"
+#define PWQ_MODEL_VERSION        1
+#define PWQ_MODEL_ENDIAN         0x01020304
+#define PWQ_MODEL_LETTERS        26
+#define PWQ_MODEL_SYMBOLS        (PWQ_MODEL_LETTERS + 1)
+#define PWQ_MODEL_STATES         (PWQ_MODEL_SYMBOLS * PWQ_MODEL_SYMBOLS)
+#define PWQ_MODEL_COLUMN_BITS    5
+#define PWQ_MODEL_COLUMNS        (1 << PWQ_MODEL_COLUMN_BITS)
+#define PWQ_MODEL_PROB_BITS      31
+#define PWQ_MODEL_PROB_ONE       (1U << PWQ_MODEL_PROB_BITS)
+#define PWQ_MODEL_SEGMENT_LEN    4 /* characters between separators */
+
+struct pwq_model_header {
+        char magic[4];
+        uint16_t version;
+        uint16_t columns;
+        uint32_t states;
+        uint32_t endian;
+};
+
+struct pwq_model_state {
+        /* column i yields letter i if the PWQ_MODEL_PROB_BITS random
+         * value is lower than prob[i], letter alias[i] otherwise */
+        uint32_t prob[PWQ_MODEL_COLUMNS];
+        uint8_t alias[PWQ_MODEL_COLUMNS];
+};
+
+#define PWQ_MODEL_STATE(_prev2, _prev1) ((_prev2) * PWQ_MODEL_SYMBOLS + (_prev1))
+
+/* Record appended to the capturefile by every pwquality_check() call.
+ * Only the lengths, character class counts and the outcome of the check
+ * are stored, never the strings themselves. The records are in the host
+ * byte order. */
+#define PWQ_CAPTURE_MAGIC        0x43515750 /* "PWQC" */
+#define PWQ_CAPTURE_VERSION      1
+#define PWQ_CAPTURE_USER_FOUND   0x01 /* the gecos check found the user */
+
+struct pwq_capture_record {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t size;
+        uint64_t time_ns;        /* CLOCK_REALTIME when the check started */
+        uint32_t check_ns;       /* duration of the whole check */
+        uint32_t gecos_ns;       /* duration of the passwd entry lookup */
+        uint32_t dict_ns;        /* duration of the dictionary check */
+        int32_t result;          /* score or error returned */
+        uint32_t rules_run;      /* bit set of PWQ_RULE_* that were run */
+        uint16_t length;
+        uint16_t old_length;
+        uint16_t user_length;
+        uint16_t gecos_length;
+        uint16_t digits;
+        uint16_t uppers;
+        uint16_t lowers;
+        uint16_t others;
+        uint8_t failed_rule;     /* PWQ_RULE_* that rejected the password */
+        uint8_t flags;
+        uint8_t reserved[2];
+};
+
+/* the checks, a new one gets the next free number so the records of the
+ * earlier versions keep their meaning, capture.c has the order they are
+ * run in */
+#define PWQ_RULE_CASE_CHANGES    0
+#define PWQ_RULE_SIMILAR         1
+#define PWQ_RULE_SIMPLE          2
+#define PWQ_RULE_ROTATED         3
+#define PWQ_RULE_MIN_CLASSES     4
+#define PWQ_RULE_PALINDROME      5
+#define PWQ_RULE_CONSECUTIVE     6
+#define PWQ_RULE_SEQUENCE        7
+#define PWQ_RULE_USER            8
+#define PWQ_RULE_GECOS           9
+#define PWQ_RULE_BAD_WORDS       10
+#define PWQ_RULE_DICT            11
+#define PWQ_RULE_OLD_SUBSTR      12
+#define PWQ_RULE_NAMES           13
+#define PWQ_RULES                14
+#define PWQ_RULE_NONE            0xff
+
+/* Summary of a pwaudit run written with -s and combined with -m. The
+ * passwords are represented only by their SipHash-2-4 with the key shared
+ * by the audits to be merged, the key_id identifies that key. The counters
+ * and the score histogram merge exactly, as do the HyperLogLog registers
+ * and the count-min sketch that estimate the number of distinct rejected
+ * passwords and the use counts of the passwords. The summaries are in the
+ * host byte order. */
+#define PWQ_SUMMARY_MAGIC        "PWQS"
+#define PWQ_SUMMARY_VERSION      1
+#define PWQ_SUMMARY_ENDIAN       0x01020304
+#define PWQ_SUMMARY_KEY_LEN      16
+#define PWQ_SUMMARY_ERRORS       64 /* results 0 (accepted) to -63 */
+#define PWQ_SUMMARY_SCORES       101
+#define PWQ_SUMMARY_HLL_BITS     14
+#define PWQ_SUMMARY_HLL_REGS     (1 << PWQ_SUMMARY_HLL_BITS)
+#define PWQ_SUMMARY_CMS_DEPTH    4
+#define PWQ_SUMMARY_CMS_WIDTH    4096
+#define PWQ_SUMMARY_TOP          32 /* most used passwords tracked */
+
+struct pwq_summary {
+        char magic[4];
+        uint16_t version;
+        uint16_t ntop;
+        uint32_t endian;
+        uint32_t reserved;
+        uint64_t key_id;
+        uint64_t lines;
+        uint64_t results[PWQ_SUMMARY_ERRORS]; /* indexed by -result */
+        uint64_t scores[PWQ_SUMMARY_SCORES];  /* accepted passwords by score */
+        uint64_t top_hash[PWQ_SUMMARY_TOP];
+        uint64_t top_count[PWQ_SUMMARY_TOP];  /* count-min estimates */
+        uint32_t cms[PWQ_SUMMARY_CMS_DEPTH][PWQ_SUMMARY_CMS_WIDTH];
+        uint8_t hll[PWQ_SUMMARY_HLL_REGS];
+};
+
+/* Index of the names for the nameindex check built by pwmknames. It is an
+ * Aho-Corasick automaton over the bytes of the lowercased names and of
+ * their reversals. The states are in the breadth-first order, so the
+ * edges lead to higher states and the failure links to lower ones, which
+ * the check relies on to stop on a damaged index. The header is followed
+ * by the states, the targets of the edges and their labels; the edges of
+ * each state are contiguous and sorted by the label. The index is in the
+ * host byte order. */
+#define PWQ_NAMES_MAGIC          "PWQN"
+#define PWQ_NAMES_VERSION        1
+#define PWQ_NAMES_ENDIAN         0x01020304
+
+struct pwq_names_header {
+        char magic[4];
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t endian;
+        uint32_t nstates;
+        uint32_t nedges;
+        uint32_t nnames;         /* including the reversed ones */
+        uint64_t digest;         /* of the sorted names */
+        uint64_t size;
+        uint32_t root[256];      /* edges of the root state, 0 if none */
+};
+
+struct pwq_names_state {
+        uint32_t edges;          /* the first edge */
+        uint32_t fail;
+        uint16_t nedges;
+        uint8_t match;           /* a name ends here or on the failure chain */
+        uint8_t reserved;
+};
+
+#define PWQ_ASYNC_DEFAULT_THREADS 4
+#define PWQ_BATCH_MIN_SLOTS      1024
+#define PWQ_BATCH_MAX_ENTRIES    (1 << 18) /* memoized inputs per batch */
+#define PWQ_USERS_MIN_SLOTS      1024
+
+/* check.c */
+#ifdef HAVE_CRACK_H
+extern pthread_mutex_t cracklib_lock;
+#endif
+
+struct pwq_users;
+
+int
+check_with_users(pwquality_settings_t *pwq, const char *password,
+        const char *oldpassword, const char *user, struct pwq_users *users,
+        void **auxerror);
+
+/* check_ref.c, linked into pwqcheckdiff only */
+int
+pwquality_check_reference(pwquality_settings_t *pwq, const char *password,
+        const char *oldpassword, const char *user, void **auxerror);
+
+void
+pwquality_reference_names(const char *nameindex, char **names, size_t n);
+
+/* siphash.c */
+uint64_t
+siphash24(const unsigned char *key, const void *data, size_t len);
+
+/* summary.c, linked into pwaudit only */
+void
+summary_init(struct pwq_summary *s, const unsigned char *key);
+
+void
+summary_add(struct pwq_summary *s, const unsigned char *key,
+        const char *password, int result);
+
+int
+summary_merge(struct pwq_summary *dst, const struct pwq_summary *src);
+
+int
+summary_read(const char *path, struct pwq_summary *s);
+
+int
+summary_write(const char *path, const struct pwq_summary *s);
+
+void
+summary_report(const struct pwq_summary *s);
+
+/* users.c */
+struct pwq_users *
+users_new(void);
+
+int
+users_load(struct pwq_users *users, const char *passwdfile);
+
+int
+users_lookup(struct pwq_users *users, const char *name,
+        const char **words, size_t *gecoslen);
+
+void
+users_free(struct pwq_users *users);
+
+/* names.c */
+int
+names_check(pwquality_settings_t *pwq, const char *new);
+
+int
+names_reset(pwquality_settings_t *pwq);
+
+void
+names_unload(pwquality_settings_t *pwq);
+
+/* namesbuild.c, linked into pwmknames and pwqcheckdiff only */
+struct pwq_names_list {
+        char **v;
+        size_t n;
+        size_t alloc;
+};
+
+int
+names_list_add(struct pwq_names_list *l, const char *s, size_t len);
+
+int
+names_list_finish(struct pwq_names_list *l);
+
+uint64_t
+names_list_digest(const struct pwq_names_list *l);
+
+int
+names_index_write(const struct pwq_names_list *l, uint64_t digest,
+        const char *path, unsigned long *nstates);
+
+void
+names_list_free(struct pwq_names_list *l);
+
+/* generate.c */
+int
+get_entropy_bits(char *buf, int nbits);
+
+/* dict.c */
+const char *
+dict_path(pwquality_settings_t *pwq);
+
+void
+dict_preload_once(pwquality_settings_t *pwq);
+
+int
+dict_reset(pwquality_settings_t *pwq);
+
+void
+dict_unload(pwquality_settings_t *pwq);
+
+/* capture.c */
+uint64_t
+capture_clock(void);
+
+uint32_t
+capture_elapsed(uint64_t start);
+
+uint64_t
+capture_start(struct pwq_capture_record *rec);
+
+void
+capture_finish(pwquality_settings_t *pwq, struct pwq_capture_record *rec,
+        uint64_t start, int result, const char *password,
+        const char *oldpassword, const char *user);
+
+void
+capture_close(pwquality_settings_t *pwq);
+
 #ifndef PWQUALITY_DEFAULT_CFGFILE
 #define PWQUALITY_DEFAULT_CFGFILE "/etc/security/pwquality.conf"
 #endif
@@ -36,6 +36,11 @@ extern "C" {
 #define PWQ_SETTING_ENFORCE_ROOT    19
 #define PWQ_SETTING_LOCAL_USERS     20
 #define PWQ_SETTING_USER_SUBSTR     21
+#define PWQ_SETTING_GEN_MODEL       22
+#define PWQ_SETTING_DICT_PRELOAD    23
+#define PWQ_SETTING_CAPTURE_FILE    24
+#define PWQ_SETTING_OLD_SUBSTR      25
+#define PWQ_SETTING_NAME_INDEX      26
 
 #define PWQ_MAX_ENTROPY_BITS       256
 #define PWQ_MIN_ENTROPY_BITS       56
@@ -72,6 +77,12 @@ extern "C" {
 #define PWQ_ERROR_MAX_CLASS_REPEAT             -27
 #define PWQ_ERROR_BAD_WORDS                    -28
 #define PWQ_ERROR_MAX_SEQUENCE                 -29
+#define PWQ_ERROR_GEN_MODEL                    -30
+#define PWQ_ERROR_DICT_PRELOAD                 -31
+#define PWQ_ERROR_OLD_SUBSTR                   -32
+#define PWQ_ERROR_USERS_PREFETCH               -33
+#define PWQ_ERROR_NAMES                        -34
+#define PWQ_ERROR_NAME_INDEX                   -35
 
 typedef struct pwquality_settings pwquality_settings_t;
 
@@ -83,6 +94,13 @@ pwquality_default_settings(void);
 void
 pwquality_free_settings(pwquality_settings_t *pwq);
 
+/* Return a copy of the settings or NULL on allocation failure. The
+ * preloaded dictionary and the mapped index of names are shared with
+ * the copy until it changes the settings they depend on. The settings
+ * can be copied while other threads check passwords with them. */
+pwquality_settings_t *
+pwquality_copy_settings(pwquality_settings_t *pwq);
+
 /* Parse the configuration file (if cfgfile is NULL then the default one).
  * If auxerror is not NULL it also possibly returns auxiliary error information
  * that must be passed into pwquality_strerror() function.
@@ -119,7 +137,9 @@ int
 pwquality_get_str_value(pwquality_settings_t *pwq, int setting, const char **value);
 
 /* Generate a random password of entropy_bits entropy and check it according to
- * the settings. */
+ * the settings.
+ * New in 1.4.6: If the PWQ_SETTING_GEN_MODEL is set, the password is generated
+ * from the character transition model stored in that file. */
 int
 pwquality_generate(pwquality_settings_t *pwq, int entropy_bits,
         char **password);
@@ -135,11 +155,87 @@ pwquality_generate(pwquality_settings_t *pwq, int entropy_bits,
  * is not returned.
  * Not passing the *auxerror into pwquality_strerror() can lead to memory leaks.
  * The score depends on PWQ_SETTING_MIN_LENGTH. If it is set higher,
- * the score for the same passwords will be lower. */ 
+ * the score for the same passwords will be lower.
+ * New in 1.4.6: If the PWQ_SETTING_CAPTURE_FILE is set, the lengths of the
+ * strings, the outcome and the timing of the check are appended to that
+ * file for a later replay with pwreplay. */ 
 int
 pwquality_check(pwquality_settings_t *pwq, const char *password,
         const char *oldpassword, const char *user, void **auxerror);
 
+typedef struct pwquality_batch pwquality_batch_t;
+
+/* Start a batch of password checks with the settings.
+ * The settings must not be modified while the batch is in use. */
+pwquality_batch_t *
+pwquality_batch_new(pwquality_settings_t *pwq);
+
+/* Check the password the same way as pwquality_check() does.
+ * The result of identical (password, oldpassword, user) inputs is
+ * remembered for the lifetime of the batch and returned without
+ * repeating the check. */
+int
+pwquality_batch_check(pwquality_batch_t *batch, const char *password,
+        const char *oldpassword, const char *user, void **auxerror);
+
+/* Obtain the number of checks done in the batch and how many of them
+ * were answered from the remembered results. */
+void
+pwquality_batch_stats(pwquality_batch_t *batch, unsigned long *checks,
+        unsigned long *hits);
+
+/* Read the GECOS fields of all users from the file in the /etc/passwd
+ * format, or enumerate them with getpwent() if passwdfile is NULL, so the
+ * GECOS check of the batch does not look up each user separately. The
+ * users not found there are still looked up with getpwnam_r(). Nothing is
+ * read if the GECOS check is disabled. The getpwent() enumeration is not
+ * thread safe. */
+int
+pwquality_batch_prefetch_users(pwquality_batch_t *batch,
+        const char *passwdfile);
+
+/* Wipe the remembered inputs and free the batch. */
+void
+pwquality_batch_free(pwquality_batch_t *batch);
+
+typedef struct pwquality_async pwquality_async_t;
+
+/* Start nthreads worker threads (or a default number if nthreads <= 0)
+ * that check passwords with the settings in the background.
+ * The settings must not be modified while the object is in use. */
+pwquality_async_t *
+pwquality_async_new(pwquality_settings_t *pwq, int nthreads);
+
+/* Return the file descriptor that becomes readable when there are
+ * completed checks to be fetched with pwquality_async_result(). */
+int
+pwquality_async_fd(pwquality_async_t *async);
+
+/* Queue the password to be checked as with pwquality_check(). The
+ * strings are copied, the cookie is returned with the result. */
+int
+pwquality_check_async(pwquality_async_t *async, const char *password,
+        const char *oldpassword, const char *user, void *cookie);
+
+/* Fetch a completed check without blocking. It returns 1 and fills in
+ * the cookie, the result of the check and the auxiliary error information,
+ * or 0 if there are no more completed checks. The results should be
+ * fetched until 0 is returned each time the file descriptor is readable. */
+int
+pwquality_async_result(pwquality_async_t *async, void **cookie, int *result,
+        void **auxerror);
+
+/* Stop the worker threads and free the object including the checks
+ * that were not fetched. */
+void
+pwquality_async_free(pwquality_async_t *async);
+
+/* Read the dictionary files into memory so the first dictionary check
+ * does not wait for the disk. If PWQ_SETTING_DICT_PRELOAD is 2 the files
+ * stay mapped and locked in memory until the settings are freed. */
+int
+pwquality_preload_dict(pwquality_settings_t *pwq);
+
 /* Translate the error code and auxiliary message into a localized
  * text message.
  * If buf is NULL it uses an internal static buffer which
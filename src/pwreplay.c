@@ -0,0 +1,487 @@
+/*
+ * pwreplay - a tool for replaying the captured password check workload
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <libgen.h>
+#include <locale.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+#define MAX_THREADS 256
+#define LATE_NS 1000000 /* start later than this behind schedule is late */
+
+static const char others[] = "!@#$%^&*-_=+.,;:";
+
+struct replay {
+        pwquality_settings_t *pwq;
+        struct pwq_capture_record *recs;
+        size_t nrecs;
+        size_t next;
+        uint32_t *latency;
+        int *result;
+        double speed;
+        const char *realuser;
+        uint64_t base;
+        unsigned long late;
+        pthread_mutex_t lock;
+};
+
+void
+usage(const char *progname) {
+        fprintf(stderr, _("Usage: %s [-d] [-j threads] [-s speed] [-u user] <capture-file>\n"), progname);
+        fprintf(stderr, _("       The command checks synthesized passwords with the features and at the rate\n"
+                          "       recorded in the capture file and compares the check latencies.\n"));
+}
+
+static uint64_t
+now_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t
+rnd(uint64_t *state, uint32_t n)
+{
+        /* xorshift64*, the inputs need not be unpredictable */
+        *state ^= *state >> 12;
+        *state ^= *state << 25;
+        *state ^= *state >> 27;
+        return ((*state * 0x2545F4914F6CDD1DULL) >> 32) % n;
+}
+
+static void
+random_lower(uint64_t *rng, char *buf, size_t len)
+{
+        size_t i;
+
+        for (i = 0; i < len; i++)
+                buf[i] = 'a' + rnd(rng, 26);
+        buf[len] = '\0';
+}
+
+static int
+get_int(pwquality_settings_t *pwq, int setting)
+{
+        int value = 0;
+
+        (void)pwquality_get_int_value(pwq, setting, &value);
+        return value;
+}
+
+/* make up a password with the recorded class counts and shape it so
+ * that it is rejected by the same rule if that is possible without
+ * knowing the original strings */
+static void
+synthesize(struct replay *r, const struct pwq_capture_record *rec,
+        uint64_t *rng, char *pw, char *old, char *user)
+{
+        size_t len = rec->length;
+        size_t i, n, pos = 0;
+        const char *realuser = NULL;
+
+        for (i = 0; i < rec->digits && pos < len; i++)
+                pw[pos++] = '0' + rnd(rng, 10);
+        for (i = 0; i < rec->uppers && pos < len; i++)
+                pw[pos++] = 'A' + rnd(rng, 26);
+        for (i = 0; i < rec->others && pos < len; i++)
+                pw[pos++] = others[rnd(rng, sizeof(others) - 1)];
+        while (pos < len)
+                pw[pos++] = 'a' + rnd(rng, 26);
+        pw[len] = '\0';
+
+        for (i = len; i > 1; i--) {
+                char c;
+
+                n = rnd(rng, i);
+                c = pw[i - 1];
+                pw[i - 1] = pw[n];
+                pw[n] = c;
+        }
+
+        random_lower(rng, old, rec->old_length);
+        random_lower(rng, user, rec->user_length);
+        if (r->realuser && (rec->flags & PWQ_CAPTURE_USER_FOUND))
+                realuser = r->realuser;
+
+        switch (rec->failed_rule) {
+        case PWQ_RULE_CASE_CHANGES:
+                for (i = 0; i <= len; i++)
+                        old[i] = islower((unsigned char)pw[i]) ?
+                                toupper((unsigned char)pw[i]) :
+                                tolower((unsigned char)pw[i]);
+                break;
+        case PWQ_RULE_SIMILAR:
+                memcpy(old, pw, len + 1);
+                if (len > 0)
+                        old[len - 1] = pw[len - 1] == 'x' ? 'y' : 'x';
+                break;
+        case PWQ_RULE_OLD_SUBSTR:
+                n = get_int(r->pwq, PWQ_SETTING_OLD_SUBSTR);
+                if (n <= len && n <= rec->old_length)
+                        for (i = 0; i < n; i++)
+                                old[i] = tolower((unsigned char)pw[i]);
+                break;
+        case PWQ_RULE_ROTATED:
+                if (len > 1) {
+                        memcpy(old, pw + 1, len - 1);
+                        old[len - 1] = pw[0];
+                        old[len] = '\0';
+                }
+                break;
+        case PWQ_RULE_PALINDROME:
+                for (i = 0; i < len / 2; i++)
+                        pw[len - 1 - i] = pw[i];
+                break;
+        case PWQ_RULE_CONSECUTIVE:
+                n = get_int(r->pwq, PWQ_SETTING_MAX_REPEAT) + 1;
+                for (i = 1; i < n && i < len; i++)
+                        pw[i] = pw[0];
+                break;
+        case PWQ_RULE_SEQUENCE:
+                n = get_int(r->pwq, PWQ_SETTING_MAX_SEQUENCE) + 1;
+                for (i = 0; i < n && i < len && i < 26; i++)
+                        pw[i] = 'a' + i;
+                break;
+        case PWQ_RULE_USER:
+                n = rec->user_length;
+                if (n > 0 && n <= len) {
+                        for (i = 0; i < n; i++)
+                                user[i] = tolower((unsigned char)pw[i]);
+                        user[n] = '\0';
+                        realuser = NULL;
+                }
+                break;
+        case PWQ_RULE_BAD_WORDS: {
+                const char *words = NULL;
+
+                (void)pwquality_get_str_value(r->pwq, PWQ_SETTING_BAD_WORDS, &words);
+                for (i = 0; words && words[i] != '\0' && i < len &&
+                        !isspace((unsigned char)words[i]) && words[i] != ','; i++)
+                        pw[i] = words[i];
+                break;
+        }
+        }
+
+        if (realuser)
+                strcpy(user, realuser);
+}
+
+static void *
+replay_thread(void *arg)
+{
+        struct replay *r = arg;
+        uint64_t rng = 0x9e3779b97f4a7c15ULL ^ (uintptr_t)&rng;
+        char *pw = NULL, *old = NULL, *user = NULL;
+        size_t userlen = r->realuser ? strlen(r->realuser) : 0;
+
+        for (;;) {
+                const struct pwq_capture_record *rec;
+                struct timespec due;
+                uint64_t t, start;
+                size_t i;
+                void *auxerror;
+
+                pthread_mutex_lock(&r->lock);
+                i = r->next++;
+                pthread_mutex_unlock(&r->lock);
+                if (i >= r->nrecs)
+                        break;
+                rec = &r->recs[i];
+
+                pw = realloc(pw, rec->length + 1);
+                old = realloc(old, (rec->old_length > rec->length ?
+                        rec->old_length : rec->length) + 1);
+                user = realloc(user, (rec->user_length > userlen ?
+                        rec->user_length : userlen) + 1);
+                if (pw == NULL || old == NULL || user == NULL) {
+                        fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                        exit(2);
+                }
+                synthesize(r, rec, &rng, pw, old, user);
+
+                if (r->speed > 0) {
+                        t = r->base + (rec->time_ns - r->recs[0].time_ns) / r->speed;
+                        due.tv_sec = t / 1000000000;
+                        due.tv_nsec = t % 1000000000;
+                        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                                &due, NULL) == EINTR)
+                                ;
+                        if (now_ns() > t + LATE_NS)
+                                __atomic_add_fetch(&r->late, 1, __ATOMIC_RELAXED);
+                }
+
+                start = now_ns();
+                r->result[i] = pwquality_check(r->pwq, pw,
+                        *old ? old : NULL, *user ? user : NULL, &auxerror);
+                t = now_ns() - start;
+                r->latency[i] = t > UINT32_MAX ? UINT32_MAX : t;
+        }
+
+        free(pw);
+        free(old);
+        free(user);
+        return NULL;
+}
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+        uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+        return x < y ? -1 : x > y;
+}
+
+/* the records are appended when the checks finish, so they are not in
+   the order of the start times the replay schedules by, and the clock
+   can be stepped back while capturing */
+static int
+cmp_time(const void *a, const void *b)
+{
+        const struct pwq_capture_record *x = a, *y = b;
+
+        return x->time_ns < y->time_ns ? -1 : x->time_ns > y->time_ns;
+}
+
+static void
+print_percentiles(const char *label, uint32_t *v, size_t n)
+{
+        qsort(v, n, sizeof(*v), cmp_u32);
+        printf("%-10s %10.1f %10.1f %10.1f %10.1f %10.1f\n", label,
+                v[n / 2] / 1e3, v[n * 9 / 10] / 1e3, v[n * 99 / 100] / 1e3,
+                v[n * 999 / 1000] / 1e3, v[n - 1] / 1e3);
+}
+
+static struct pwq_capture_record *
+read_capture(const char *fname, size_t *nrecs)
+{
+        struct pwq_capture_record *recs = NULL, rec;
+        size_t n = 0, alloc = 0;
+        FILE *f;
+
+        if ((f = fopen(fname, "r")) == NULL) {
+                fprintf(stderr, _("Error: Cannot open %s: %s\n"), fname, strerror(errno));
+                exit(3);
+        }
+
+        while (fread(&rec, sizeof(rec), 1, f) == 1) {
+                if (rec.magic != PWQ_CAPTURE_MAGIC ||
+                    rec.version != PWQ_CAPTURE_VERSION ||
+                    rec.size < sizeof(rec)) {
+                        fprintf(stderr, _("Error: %s is not a capture file of this system\n"), fname);
+                        exit(3);
+                }
+                /* skip what later versions could add */
+                if (rec.size > sizeof(rec) &&
+                    fseek(f, rec.size - sizeof(rec), SEEK_CUR) == -1)
+                        break;
+                if (n == alloc) {
+                        alloc = alloc ? alloc * 2 : 1024;
+                        recs = realloc(recs, alloc * sizeof(*recs));
+                        if (recs == NULL) {
+                                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                                exit(2);
+                        }
+                }
+                recs[n++] = rec;
+        }
+        fclose(f);
+
+        *nrecs = n;
+        return recs;
+}
+
+static void
+dump(const struct pwq_capture_record *recs, size_t nrecs)
+{
+        size_t i;
+
+        printf("# time_ns\tresult\tlen\tdigits\tuppers\tlowers\tothers\told\tuser\tgecos\trules\tfailed\tcheck_ns\tgecos_ns\tdict_ns\n");
+        for (i = 0; i < nrecs; i++) {
+                const struct pwq_capture_record *rec = &recs[i];
+
+                printf("%llu\t%d\t%u\t%u\t%u\t%u\t%u\t%u\t%u\t%d\t0x%03x\t%d\t%u\t%u\t%u\n",
+                        (unsigned long long)rec->time_ns, rec->result,
+                        rec->length, rec->digits, rec->uppers, rec->lowers,
+                        rec->others, rec->old_length, rec->user_length,
+                        (rec->flags & PWQ_CAPTURE_USER_FOUND) ? rec->gecos_length : -1,
+                        rec->rules_run,
+                        rec->failed_rule == PWQ_RULE_NONE ? -1 : rec->failed_rule,
+                        rec->check_ns, rec->gecos_ns, rec->dict_ns);
+        }
+}
+
+/* replay the captured checks */
+int
+main(int argc, char *argv[])
+{
+        struct replay r;
+        pthread_t threads[MAX_THREADS];
+        uint32_t *recorded;
+        unsigned long matches = 0;
+        uint64_t start, span;
+        int nthreads = 1, dumponly = 0;
+        int i, rv, opt;
+        size_t j;
+        void *auxerror;
+
+#ifdef ENABLE_NLS
+        setlocale(LC_ALL, "");
+        bindtextdomain("libpwquality", "/usr/share/locale");
+        textdomain("libpwquality");
+#endif
+
+        memset(&r, 0, sizeof(r));
+        r.speed = 1.0;
+
+        while ((opt = getopt(argc, argv, "dj:s:u:")) != -1) {
+                switch (opt) {
+                case 'd':
+                        dumponly = 1;
+                        break;
+                case 'j':
+                        nthreads = atoi(optarg);
+                        if (nthreads < 1 || nthreads > MAX_THREADS) {
+                                usage(basename(argv[0]));
+                                exit(3);
+                        }
+                        break;
+                case 's':
+                        r.speed = atof(optarg);
+                        if (r.speed < 0) {
+                                usage(basename(argv[0]));
+                                exit(3);
+                        }
+                        break;
+                case 'u':
+                        r.realuser = optarg;
+                        break;
+                default:
+                        usage(basename(argv[0]));
+                        exit(3);
+                }
+        }
+
+        if (optind != argc - 1) {
+                usage(basename(argv[0]));
+                exit(3);
+        }
+
+        r.recs = read_capture(argv[optind], &r.nrecs);
+        if (r.nrecs == 0) {
+                fprintf(stderr, _("Error: No checks were captured in %s\n"), argv[optind]);
+                exit(1);
+        }
+        qsort(r.recs, r.nrecs, sizeof(*r.recs), cmp_time);
+
+        if (dumponly) {
+                dump(r.recs, r.nrecs);
+                free(r.recs);
+                return 0;
+        }
+
+        r.pwq = pwquality_default_settings();
+        r.latency = calloc(r.nrecs, sizeof(*r.latency));
+        r.result = calloc(r.nrecs, sizeof(*r.result));
+        recorded = calloc(r.nrecs, sizeof(*recorded));
+        if (r.pwq == NULL || r.latency == NULL || r.result == NULL || recorded == NULL) {
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, PWQ_ERROR_MEM_ALLOC, NULL));
+                exit(2);
+        }
+
+        if ((rv=pwquality_read_config(r.pwq, NULL, &auxerror)) != 0) {
+                pwquality_free_settings(r.pwq);
+                fprintf(stderr, _("Error: %s\n"), pwquality_strerror(NULL, 0, rv, auxerror));
+                exit(3);
+        }
+        /* do not append the replayed checks to the capture */
+        (void)pwquality_set_str_value(r.pwq, PWQ_SETTING_CAPTURE_FILE, NULL);
+
+        pthread_mutex_init(&r.lock, NULL);
+        r.base = start = now_ns();
+        for (i = 0; i < nthreads; i++) {
+                if (pthread_create(&threads[i], NULL, replay_thread, &r) != 0) {
+                        fprintf(stderr, _("Error: Cannot start the replay threads\n"));
+                        exit(2);
+                }
+        }
+        for (i = 0; i < nthreads; i++)
+                pthread_join(threads[i], NULL);
+        span = now_ns() - start;
+
+        for (j = 0; j < r.nrecs; j++) {
+                recorded[j] = r.recs[j].check_ns;
+                if (r.result[j] == r.recs[j].result ||
+                    (r.result[j] >= 0 && r.recs[j].result >= 0))
+                        ++matches;
+        }
+
+        printf(_("Replayed %lu checks captured over %.3f seconds in %.3f seconds, %lu started late\n"),
+                (unsigned long)r.nrecs,
+                (r.recs[r.nrecs - 1].time_ns - r.recs[0].time_ns) / 1e9,
+                span / 1e9, r.late);
+        printf(_("The outcome of %lu checks (%.1f%%) matched the capture\n"),
+                matches, 100.0 * matches / r.nrecs);
+        printf("%-10s %10s %10s %10s %10s %10s\n", _("usec"),
+                "p50", "p90", "p99", "p99.9", "max");
+        print_percentiles(_("captured"), recorded, r.nrecs);
+        print_percentiles(_("replayed"), r.latency, r.nrecs);
+
+        pthread_mutex_destroy(&r.lock);
+        pwquality_free_settings(r.pwq);
+        free(recorded);
+        free(r.latency);
+        free(r.result);
+        free(r.recs);
+
+        return 0;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -13,18 +13,46 @@
 #include <ctype.h>
 #include <errno.h>
 #include <dirent.h>
-#ifdef HAVE_CRACK_H
-#include <crack.h>
-#endif
 
 #include "pwquality.h"
 #include "pwqprivate.h"
 
+#ifdef PWQ_FIXED_POLICY
+/* the check settings are fixed at build time, changes are ignored */
+static int
+fixed_setting(int setting)
+{
+        switch(setting) {
+        case PWQ_SETTING_DIFF_OK:
+        case PWQ_SETTING_MIN_LENGTH:
+        case PWQ_SETTING_DIG_CREDIT:
+        case PWQ_SETTING_UP_CREDIT:
+        case PWQ_SETTING_LOW_CREDIT:
+        case PWQ_SETTING_OTH_CREDIT:
+        case PWQ_SETTING_MIN_CLASS:
+        case PWQ_SETTING_MAX_REPEAT:
+        case PWQ_SETTING_MAX_CLASS_REPEAT:
+        case PWQ_SETTING_MAX_SEQUENCE:
+        case PWQ_SETTING_GECOS_CHECK:
+        case PWQ_SETTING_DICT_CHECK:
+        case PWQ_SETTING_USER_CHECK:
+        case PWQ_SETTING_USER_SUBSTR:
+        case PWQ_SETTING_OLD_SUBSTR:
+        case PWQ_SETTING_BAD_WORDS:
+                return 1;
+        }
+        return 0;
+}
+#endif
+
 /* returns default pwquality settings to be used in other library calls */
 pwquality_settings_t *
 pwquality_default_settings(void)
 {
         pwquality_settings_t *pwq;
+#ifdef PWQ_FIXED_POLICY
+        const char *bad_words = PWQ_POLICY_bad_words;
+#endif
 
         pwq = calloc(1, sizeof(*pwq));
         if (!pwq)
@@ -39,10 +67,41 @@ pwquality_default_settings(void)
         pwq->dict_check = PWQ_DEFAULT_DICT_CHECK;
         pwq->user_check = PWQ_DEFAULT_USER_CHECK;
         pwq->user_substr = PWQ_DEFAULT_USER_SUBSTR;
+        pwq->old_substr = PWQ_DEFAULT_OLD_SUBSTR;
         pwq->enforcing = PWQ_DEFAULT_ENFORCING;
         pwq->retry_times = PWQ_DEFAULT_RETRY_TIMES;
         pwq->enforce_for_root = PWQ_DEFAULT_ENFORCE_ROOT;
         pwq->local_users_only = PWQ_DEFAULT_LOCAL_USERS;
+        pwq->dict_preload = PWQ_DEFAULT_DICT_PRELOAD;
+        pwq->capture_fd = -1;
+        if (dict_reset(pwq) != 0 || names_reset(pwq) != 0) {
+                pwquality_free_settings(pwq);
+                return NULL;
+        }
+
+#ifdef PWQ_FIXED_POLICY
+        /* keep the values reported by the getters the same as those
+         * used by the check */
+        pwq->diff_ok = PWQ_POLICY_diff_ok;
+        pwq->min_length = PWQ_POLICY_min_length;
+        pwq->dig_credit = PWQ_POLICY_dig_credit;
+        pwq->up_credit = PWQ_POLICY_up_credit;
+        pwq->low_credit = PWQ_POLICY_low_credit;
+        pwq->oth_credit = PWQ_POLICY_oth_credit;
+        pwq->min_class = PWQ_POLICY_min_class;
+        pwq->max_repeat = PWQ_POLICY_max_repeat;
+        pwq->max_class_repeat = PWQ_POLICY_max_class_repeat;
+        pwq->max_sequence = PWQ_POLICY_max_sequence;
+        pwq->gecos_check = PWQ_POLICY_gecos_check;
+        pwq->dict_check = PWQ_POLICY_dict_check;
+        pwq->user_check = PWQ_POLICY_user_check;
+        pwq->user_substr = PWQ_POLICY_user_substr;
+        pwq->old_substr = PWQ_POLICY_old_substr;
+        if (bad_words && (pwq->bad_words = strdup(bad_words)) == NULL) {
+                pwquality_free_settings(pwq);
+                return NULL;
+        }
+#endif
 
         return pwq;
 }
@@ -52,12 +111,53 @@ void
 pwquality_free_settings(pwquality_settings_t *pwq)
 {
         if (pwq) {
+                dict_unload(pwq);
                 free(pwq->dict_path);
                 free(pwq->bad_words);
+                free(pwq->gen_model);
+                capture_close(pwq);
+                free(pwq->capture_file);
+                names_unload(pwq);
+                free(pwq->name_index);
                 free(pwq);
         }
 }
 
+static int
+copy_str(char **dst, const char *src)
+{
+        *dst = NULL;
+        if (src && (*dst = strdup(src)) == NULL)
+                return -1;
+        return 0;
+}
+
+/* copies the settings, the preloaded dictionary and the mapped index of
+   names are shared with the copy instead of loading them again */
+pwquality_settings_t *
+pwquality_copy_settings(pwquality_settings_t *pwq)
+{
+        pwquality_settings_t *copy;
+
+        copy = malloc(sizeof(*copy));
+        if (!copy)
+                return NULL;
+
+        *copy = *pwq;
+        copy->capture_fd = -1;
+        __atomic_add_fetch(&copy->dict->refs, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&copy->names->refs, 1, __ATOMIC_RELAXED);
+        if (copy_str(&copy->bad_words, pwq->bad_words) < 0 ||
+            copy_str(&copy->dict_path, pwq->dict_path) < 0 ||
+            copy_str(&copy->gen_model, pwq->gen_model) < 0 ||
+            copy_str(&copy->capture_file, pwq->capture_file) < 0 ||
+            copy_str(&copy->name_index, pwq->name_index) < 0) {
+                pwquality_free_settings(copy);
+                return NULL;
+        }
+        return copy;
+}
+
 
 static const struct setting_mapping s_map[] = {
  { "difok", PWQ_SETTING_DIFF_OK, PWQ_TYPE_INT},
@@ -74,9 +174,14 @@ static const struct setting_mapping s_map[] = {
  { "dictcheck", PWQ_SETTING_DICT_CHECK, PWQ_TYPE_INT},
  { "usercheck", PWQ_SETTING_USER_CHECK, PWQ_TYPE_INT},
  { "usersubstr", PWQ_SETTING_USER_SUBSTR, PWQ_TYPE_INT},
+ { "oldsubstr", PWQ_SETTING_OLD_SUBSTR, PWQ_TYPE_INT},
  { "enforcing", PWQ_SETTING_ENFORCING, PWQ_TYPE_INT},
  { "badwords", PWQ_SETTING_BAD_WORDS, PWQ_TYPE_STR},
  { "dictpath", PWQ_SETTING_DICT_PATH, PWQ_TYPE_STR},
+ { "genmodel", PWQ_SETTING_GEN_MODEL, PWQ_TYPE_STR},
+ { "dictpreload", PWQ_SETTING_DICT_PRELOAD, PWQ_TYPE_INT},
+ { "capturefile", PWQ_SETTING_CAPTURE_FILE, PWQ_TYPE_STR},
+ { "nameindex", PWQ_SETTING_NAME_INDEX, PWQ_TYPE_STR},
  { "retry", PWQ_SETTING_RETRY_TIMES, PWQ_TYPE_INT},
  { "enforce_for_root", PWQ_SETTING_ENFORCE_ROOT, PWQ_TYPE_SET},
  { "local_users_only", PWQ_SETTING_LOCAL_USERS, PWQ_TYPE_SET}
@@ -309,6 +414,11 @@ pwquality_set_option(pwquality_settings_t *pwq, const char *option)
 int
 pwquality_set_int_value(pwquality_settings_t *pwq, int setting, int value)
 {
+#ifdef PWQ_FIXED_POLICY
+        if (fixed_setting(setting))
+                return 0;
+#endif
+
         switch(setting) {
         case PWQ_SETTING_DIFF_OK:
                 pwq->diff_ok = value;
@@ -356,6 +466,9 @@ pwquality_set_int_value(pwquality_settings_t *pwq, int setting, int value)
         case PWQ_SETTING_USER_SUBSTR:
                 pwq->user_substr = value;
                 break;
+        case PWQ_SETTING_OLD_SUBSTR:
+                pwq->old_substr = value;
+                break;
         case PWQ_SETTING_ENFORCING:
                 pwq->enforcing = value;
                 break;
@@ -368,6 +481,11 @@ pwquality_set_int_value(pwquality_settings_t *pwq, int setting, int value)
         case PWQ_SETTING_LOCAL_USERS:
                 pwq->local_users_only = value;
                 break;
+        case PWQ_SETTING_DICT_PRELOAD:
+                if (value != pwq->dict_preload && dict_reset(pwq) != 0)
+                        return PWQ_ERROR_MEM_ALLOC;
+                pwq->dict_preload = value;
+                break;
         default:
                 return PWQ_ERROR_NON_INT_SETTING;
         }
@@ -375,6 +493,12 @@ pwquality_set_int_value(pwquality_settings_t *pwq, int setting, int value)
         return 0;
 }
 
+static int
+same_str(const char *a, const char *b)
+{
+        return a == b || (a && b && strcmp(a, b) == 0);
+}
+
 /* set value of a string setting */
 int
 pwquality_set_str_value(pwquality_settings_t *pwq, int setting,
@@ -382,6 +506,11 @@ pwquality_set_str_value(pwquality_settings_t *pwq, int setting,
 {
         char *dup;
 
+#ifdef PWQ_FIXED_POLICY
+        if (fixed_setting(setting))
+                return 0;
+#endif
+
         if (value == NULL || *value == '\0') {
                 dup = NULL;
         } else {
@@ -396,9 +525,30 @@ pwquality_set_str_value(pwquality_settings_t *pwq, int setting,
                 pwq->bad_words = dup;
                 break;
         case PWQ_SETTING_DICT_PATH:
+                if (!same_str(dup, pwq->dict_path) && dict_reset(pwq) != 0) {
+                        free(dup);
+                        return PWQ_ERROR_MEM_ALLOC;
+                }
                 free(pwq->dict_path);
                 pwq->dict_path = dup;
                 break;
+        case PWQ_SETTING_GEN_MODEL:
+                free(pwq->gen_model);
+                pwq->gen_model = dup;
+                break;
+        case PWQ_SETTING_CAPTURE_FILE:
+                capture_close(pwq);
+                free(pwq->capture_file);
+                pwq->capture_file = dup;
+                break;
+        case PWQ_SETTING_NAME_INDEX:
+                if (!same_str(dup, pwq->name_index) && names_reset(pwq) != 0) {
+                        free(dup);
+                        return PWQ_ERROR_MEM_ALLOC;
+                }
+                free(pwq->name_index);
+                pwq->name_index = dup;
+                break;
         default:
                 free(dup);
                 return PWQ_ERROR_NON_STR_SETTING;
@@ -454,6 +604,9 @@ pwquality_get_int_value(pwquality_settings_t *pwq, int setting, int *value)
         case PWQ_SETTING_USER_SUBSTR:
                 *value = pwq->user_substr;
                 break;
+        case PWQ_SETTING_OLD_SUBSTR:
+                *value = pwq->old_substr;
+                break;
         case PWQ_SETTING_ENFORCING:
                 *value = pwq->enforcing;
                 break;
@@ -466,6 +619,9 @@ pwquality_get_int_value(pwquality_settings_t *pwq, int setting, int *value)
         case PWQ_SETTING_LOCAL_USERS:
                 *value = pwq->local_users_only;
                 break;
+        case PWQ_SETTING_DICT_PRELOAD:
+                *value = pwq->dict_preload;
+                break;
         default:
                 return PWQ_ERROR_NON_INT_SETTING;
         }
@@ -482,14 +638,20 @@ pwquality_get_str_value(pwquality_settings_t *pwq, int setting, const char **val
                 break;
         case PWQ_SETTING_DICT_PATH:
                 #ifdef HAVE_CRACK_H
-                if (pwq->dict_path)
-                        *value = pwq->dict_path;
-                else
-                        *value = GetDefaultCracklibDict();
+                *value = dict_path(pwq);
                 #else
-                        *value = NULL;
+                *value = NULL;
                 #endif
                 break;
+        case PWQ_SETTING_GEN_MODEL:
+                *value = pwq->gen_model;
+                break;
+        case PWQ_SETTING_CAPTURE_FILE:
+                *value = pwq->capture_file;
+                break;
+        case PWQ_SETTING_NAME_INDEX:
+                *value = pwq->name_index;
+                break;
         default:
                 return PWQ_ERROR_NON_STR_SETTING;
         }
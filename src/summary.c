@@ -0,0 +1,342 @@
+/*
+ * pwaudit summaries that can be merged over the audited shards
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+/* the probability that a count-min estimate exceeds the true count
+   by more than e / PWQ_SUMMARY_CMS_WIDTH of all lines is e^-depth */
+#define CMS_CONFIDENCE           98
+
+void
+summary_init(struct pwq_summary *s, const unsigned char *key)
+{
+        memset(s, 0, sizeof(*s));
+        memcpy(s->magic, PWQ_SUMMARY_MAGIC, sizeof(s->magic));
+        s->version = PWQ_SUMMARY_VERSION;
+        s->endian = PWQ_SUMMARY_ENDIAN;
+        s->key_id = siphash24(key, PWQ_SUMMARY_MAGIC, sizeof(s->magic));
+}
+
+/* the rows of the count-min sketch are indexed by h1 + row * h2 */
+static size_t
+cms_index(uint64_t hash, int row)
+{
+        uint32_t h1 = (uint32_t)hash;
+        uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+
+        return (h1 + row * h2) & (PWQ_SUMMARY_CMS_WIDTH - 1);
+}
+
+static uint64_t
+cms_estimate(const struct pwq_summary *s, uint64_t hash)
+{
+        uint32_t count = UINT32_MAX;
+        int row;
+
+        for (row = 0; row < PWQ_SUMMARY_CMS_DEPTH; row++) {
+                uint32_t c = s->cms[row][cms_index(hash, row)];
+
+                if (c < count)
+                        count = c;
+        }
+        return count;
+}
+
+static void
+cms_add(struct pwq_summary *s, uint64_t hash)
+{
+        int row;
+
+        for (row = 0; row < PWQ_SUMMARY_CMS_DEPTH; row++) {
+                uint32_t *c = &s->cms[row][cms_index(hash, row)];
+
+                if (*c < UINT32_MAX)
+                        ++*c;
+        }
+}
+
+/* keep the PWQ_SUMMARY_TOP passwords with the highest counts */
+static void
+top_update(struct pwq_summary *s, uint64_t hash, uint64_t count)
+{
+        int i, min = 0;
+
+        for (i = 0; i < s->ntop; i++) {
+                if (s->top_hash[i] == hash) {
+                        s->top_count[i] = count;
+                        return;
+                }
+                if (s->top_count[i] < s->top_count[min])
+                        min = i;
+        }
+
+        if (s->ntop < PWQ_SUMMARY_TOP)
+                i = s->ntop++;
+        else if (count > s->top_count[min])
+                i = min;
+        else
+                return;
+        s->top_hash[i] = hash;
+        s->top_count[i] = count;
+}
+
+static void
+hll_add(struct pwq_summary *s, uint64_t hash)
+{
+        uint64_t rest = hash << PWQ_SUMMARY_HLL_BITS;
+        uint8_t rank = rest ? __builtin_clzll(rest) + 1 :
+                64 - PWQ_SUMMARY_HLL_BITS + 1;
+        uint8_t *reg = &s->hll[hash >> (64 - PWQ_SUMMARY_HLL_BITS)];
+
+        if (rank > *reg)
+                *reg = rank;
+}
+
+static double
+hll_estimate(const struct pwq_summary *s)
+{
+        double m = PWQ_SUMMARY_HLL_REGS, sum = 0, e;
+        int i, zeros = 0;
+
+        for (i = 0; i < PWQ_SUMMARY_HLL_REGS; i++) {
+                sum += ldexp(1.0, -s->hll[i]);
+                if (s->hll[i] == 0)
+                        zeros++;
+        }
+        e = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        /* linear counting is more precise for the small cardinalities */
+        if (e <= 2.5 * m && zeros)
+                e = m * log(m / zeros);
+        return e;
+}
+
+void
+summary_add(struct pwq_summary *s, const unsigned char *key,
+        const char *password, int result)
+{
+        uint64_t hash = siphash24(key, password, strlen(password));
+
+        s->lines++;
+        if (result >= 0) {
+                s->results[0]++;
+                s->scores[result < PWQ_SUMMARY_SCORES ? result : PWQ_SUMMARY_SCORES - 1]++;
+        } else {
+                s->results[-result < PWQ_SUMMARY_ERRORS ? -result : PWQ_SUMMARY_ERRORS - 1]++;
+                hll_add(s, hash);
+        }
+        cms_add(s, hash);
+        top_update(s, hash, cms_estimate(s, hash));
+}
+
+/* The counters, histogram, registers and sketch become exactly those of
+ * the audit of both shards at once. The most used passwords are chosen
+ * from the candidates of both summaries by their merged estimates, so a
+ * password used often overall but in none of the shards can be missed. */
+int
+summary_merge(struct pwq_summary *dst, const struct pwq_summary *src)
+{
+        uint64_t candidates[2 * PWQ_SUMMARY_TOP];
+        int i, j, n = 0;
+
+        if (dst->key_id != src->key_id)
+                return -1;
+
+        dst->lines += src->lines;
+        for (i = 0; i < PWQ_SUMMARY_ERRORS; i++)
+                dst->results[i] += src->results[i];
+        for (i = 0; i < PWQ_SUMMARY_SCORES; i++)
+                dst->scores[i] += src->scores[i];
+        for (i = 0; i < PWQ_SUMMARY_HLL_REGS; i++)
+                if (src->hll[i] > dst->hll[i])
+                        dst->hll[i] = src->hll[i];
+        for (i = 0; i < PWQ_SUMMARY_CMS_DEPTH; i++)
+                for (j = 0; j < PWQ_SUMMARY_CMS_WIDTH; j++) {
+                        uint32_t c = dst->cms[i][j] + src->cms[i][j];
+
+                        dst->cms[i][j] = c < dst->cms[i][j] ? UINT32_MAX : c;
+                }
+
+        for (i = 0; i < dst->ntop; i++)
+                candidates[n++] = dst->top_hash[i];
+        for (i = 0; i < src->ntop; i++) {
+                for (j = 0; j < dst->ntop && dst->top_hash[j] != src->top_hash[i]; j++)
+                        ;
+                if (j == dst->ntop)
+                        candidates[n++] = src->top_hash[i];
+        }
+        dst->ntop = 0;
+        for (i = 0; i < n; i++)
+                top_update(dst, candidates[i], cms_estimate(dst, candidates[i]));
+
+        return 0;
+}
+
+/* returns -1 with errno set if the file cannot be read, -2 if it is not
+   a summary of this version made on a host of the same byte order */
+int
+summary_read(const char *path, struct pwq_summary *s)
+{
+        FILE *f;
+        int rv = 0;
+
+        f = fopen(path, "r");
+        if (f == NULL)
+                return -1;
+        if (fread(s, sizeof(*s), 1, f) != 1) {
+                rv = ferror(f) ? -1 : -2;
+        } else if (fgetc(f) != EOF ||
+                   memcmp(s->magic, PWQ_SUMMARY_MAGIC, sizeof(s->magic)) != 0 ||
+                   s->version != PWQ_SUMMARY_VERSION ||
+                   s->endian != PWQ_SUMMARY_ENDIAN ||
+                   s->ntop > PWQ_SUMMARY_TOP) {
+                rv = -2;
+        }
+        fclose(f);
+        return rv;
+}
+
+/* replace the file atomically so a concurrent merge never reads
+   a partially written summary */
+int
+summary_write(const char *path, const struct pwq_summary *s)
+{
+        char *tmpname;
+        FILE *f = NULL;
+        int fd, saved;
+
+        if (asprintf(&tmpname, "%s.XXXXXX", path) < 0)
+                return -1;
+        fd = mkstemp(tmpname);
+        if (fd == -1 ||
+            (f = fdopen(fd, "w")) == NULL ||
+            fwrite(s, sizeof(*s), 1, f) != 1 ||
+            fclose(f) != 0 ||
+            rename(tmpname, path) == -1) {
+                saved = errno;
+                if (fd != -1) {
+                        if (f == NULL)
+                                close(fd);
+                        unlink(tmpname);
+                }
+                free(tmpname);
+                errno = saved;
+                return -1;
+        }
+        free(tmpname);
+        return 0;
+}
+
+static int
+score_percentile(const struct pwq_summary *s, uint64_t accepted, int percent)
+{
+        uint64_t rank = (accepted * percent + 99) / 100, seen = 0;
+        int i;
+
+        for (i = 0; i < PWQ_SUMMARY_SCORES - 1; i++) {
+                seen += s->scores[i];
+                if (seen >= rank && seen > 0)
+                        break;
+        }
+        return i;
+}
+
+void
+summary_report(const struct pwq_summary *s)
+{
+        char buf[PWQ_MAX_ERROR_MESSAGE_LEN];
+        uint64_t accepted = s->results[0];
+        uint64_t rejected = s->lines - accepted;
+        double total = s->lines ? s->lines : 1, mean = 0;
+        uint64_t counts[PWQ_SUMMARY_TOP];
+        int order[PWQ_SUMMARY_TOP];
+        int i, j;
+
+        printf(_("Lines: %llu\n"), (unsigned long long)s->lines);
+        printf(_("Accepted: %llu (%.1f%%)\n"), (unsigned long long)accepted,
+                100.0 * accepted / total);
+        if (accepted) {
+                for (i = 0; i < PWQ_SUMMARY_SCORES; i++)
+                        mean += (double)i * s->scores[i];
+                printf(_("Score: mean %.1f, 10th percentile %d, median %d, 90th percentile %d\n"),
+                        mean / accepted, score_percentile(s, accepted, 10),
+                        score_percentile(s, accepted, 50),
+                        score_percentile(s, accepted, 90));
+        }
+        printf(_("Rejected: %llu (%.1f%%), about %.0f distinct passwords\n"),
+                (unsigned long long)rejected, 100.0 * rejected / total,
+                rejected ? hll_estimate(s) : 0.0);
+        for (i = 1; i < PWQ_SUMMARY_ERRORS; i++) {
+                if (s->results[i] == 0)
+                        continue;
+                printf("%12llu\t%d\t%s\n", (unsigned long long)s->results[i], -i,
+                        pwquality_strerror(buf, sizeof(buf), -i, NULL));
+        }
+
+        if (s->ntop == 0)
+                return;
+        printf(_("Most used passwords, the counts can be higher by up to %.0f with %d%% probability:\n"),
+                ceil(M_E * s->lines / PWQ_SUMMARY_CMS_WIDTH), CMS_CONFIDENCE);
+        /* the stored counts are the estimates when the passwords were
+           last seen, sort by the final ones, there are few of them */
+        for (i = 0; i < s->ntop; i++) {
+                counts[i] = cms_estimate(s, s->top_hash[i]);
+                order[i] = i;
+                for (j = i; j > 0 && counts[order[j]] > counts[order[j - 1]]; j--) {
+                        int t = order[j];
+
+                        order[j] = order[j - 1];
+                        order[j - 1] = t;
+                }
+        }
+        for (i = 0; i < s->ntop; i++)
+                printf("%12llu\t%016llx\n", (unsigned long long)counts[order[i]],
+                        (unsigned long long)s->top_hash[order[i]]);
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
@@ -0,0 +1,279 @@
+/*
+ * libpwquality map of the GECOS words of all users
+ *
+ * See the end of the file for Copyright and License Information
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <pwd.h>
+
+#include "pwquality.h"
+#include "pwqprivate.h"
+
+/* The words are kept the way the GECOS check uses them: split on spaces,
+ * lowercased and without the words shorter than PWQ_MIN_WORD_LENGTH, so
+ * the check gives the same results as with the getpwnam_r() lookup. */
+struct users_entry {
+        uint64_t hash;
+        char *name;       /* followed by the words separated by spaces */
+        const char *words;
+        size_t gecoslen;  /* of the original GECOS field */
+};
+
+struct pwq_users {
+        unsigned char sipkey[16];
+        struct users_entry *slots;
+        size_t nslots;
+        size_t nentries;
+};
+
+struct pwq_users *
+users_new(void)
+{
+        struct pwq_users *users;
+
+        users = calloc(1, sizeof(*users));
+        if (users == NULL)
+                return NULL;
+
+        users->nslots = PWQ_USERS_MIN_SLOTS;
+        users->slots = calloc(users->nslots, sizeof(*users->slots));
+        if (users->slots == NULL ||
+            get_entropy_bits((char *)users->sipkey, sizeof(users->sipkey) * 8) < 0) {
+                free(users->slots);
+                free(users);
+                return NULL;
+        }
+        return users;
+}
+
+void
+users_free(struct pwq_users *users)
+{
+        size_t i;
+
+        if (users == NULL)
+                return;
+
+        for (i = 0; i < users->nslots; i++)
+                free(users->slots[i].name);
+        free(users->slots);
+        free(users);
+}
+
+static struct users_entry *
+find_slot(struct users_entry *slots, size_t nslots, uint64_t hash,
+          const char *name)
+{
+        size_t i = hash & (nslots - 1);
+
+        while (slots[i].name != NULL) {
+                if (slots[i].hash == hash && strcmp(slots[i].name, name) == 0)
+                        break;
+                i = (i + 1) & (nslots - 1);
+        }
+        return &slots[i];
+}
+
+static int
+grow_table(struct pwq_users *users)
+{
+        struct users_entry *slots;
+        size_t nslots = users->nslots * 2;
+        size_t i;
+
+        slots = calloc(nslots, sizeof(*slots));
+        if (slots == NULL)
+                return -1;
+
+        for (i = 0; i < users->nslots; i++) {
+                if (users->slots[i].name)
+                        *find_slot(slots, nslots, users->slots[i].hash,
+                                users->slots[i].name) = users->slots[i];
+        }
+        free(users->slots);
+        users->slots = slots;
+        users->nslots = nslots;
+        return 0;
+}
+
+/* add the user unless already present, the first entry wins as with
+   getpwnam_r() */
+static int
+users_add(struct pwq_users *users, const char *name, const char *gecos)
+{
+        struct users_entry *e;
+        size_t namelen = strlen(name);
+        size_t gecoslen = gecos ? strlen(gecos) : 0;
+        uint64_t hash;
+        char *p, *w;
+
+        hash = siphash24(users->sipkey, name, namelen);
+        e = find_slot(users->slots, users->nslots, hash, name);
+        if (e->name != NULL)
+                return 0;
+
+        if ((users->nentries + 1) * 2 > users->nslots) {
+                if (grow_table(users) < 0)
+                        return PWQ_ERROR_MEM_ALLOC;
+                e = find_slot(users->slots, users->nslots, hash, name);
+        }
+
+        p = malloc(namelen + gecoslen + 2);
+        if (p == NULL)
+                return PWQ_ERROR_MEM_ALLOC;
+        memcpy(p, name, namelen + 1);
+
+        /* copy the words long enough to be checked */
+        w = p + namelen + 1;
+        while (gecos && *gecos != '\0') {
+                size_t len = strcspn(gecos, " ");
+
+                if (len >= PWQ_MIN_WORD_LENGTH) {
+                        if (w != p + namelen + 1)
+                                *w++ = ' ';
+                        while (len--)
+                                *w++ = tolower(*gecos++);
+                } else {
+                        gecos += len;
+                }
+                if (*gecos == ' ')
+                        ++gecos;
+        }
+        *w = '\0';
+
+        e->hash = hash;
+        e->name = p;
+        e->words = p + namelen + 1;
+        e->gecoslen = gecoslen;
+        ++users->nentries;
+        return 0;
+}
+
+/* read the users from a file in the /etc/passwd format */
+static int
+users_read_file(struct pwq_users *users, const char *passwdfile)
+{
+        char *line = NULL;
+        size_t linesize = 0;
+        ssize_t len;
+        FILE *f;
+        int rv = 0;
+
+        f = fopen(passwdfile, "r");
+        if (f == NULL)
+                return PWQ_ERROR_USERS_PREFETCH;
+
+        while (!rv && (len = getline(&line, &linesize, f)) != -1) {
+                char *gecos, *p;
+                int i;
+
+                if (len > 0 && line[len - 1] == '\n')
+                        line[--len] = '\0';
+                /* skip comments and the NIS compat entries */
+                if (*line == '\0' || *line == '#' || *line == '+' || *line == '-')
+                        continue;
+
+                /* name:password:uid:gid:gecos:dir:shell */
+                gecos = line;
+                for (i = 0; i < 4 && gecos != NULL; i++) {
+                        gecos = strchr(gecos, ':');
+                        if (gecos)
+                                *gecos++ = '\0';
+                }
+                if (gecos == NULL)
+                        continue;
+                if ((p = strchr(gecos, ':')) != NULL)
+                        *p = '\0';
+
+                rv = users_add(users, line, gecos);
+        }
+
+        if (!rv && ferror(f))
+                rv = PWQ_ERROR_USERS_PREFETCH;
+        free(line);
+        fclose(f);
+        return rv;
+}
+
+/* enumerate the users with getpwent() */
+static int
+users_enumerate(struct pwq_users *users)
+{
+        struct passwd *pwd;
+        int rv = 0;
+
+        setpwent();
+        while (!rv && (pwd = getpwent()) != NULL) {
+                if (pwd->pw_name)
+                        rv = users_add(users, pwd->pw_name, pwd->pw_gecos);
+        }
+        endpwent();
+        return rv;
+}
+
+int
+users_load(struct pwq_users *users, const char *passwdfile)
+{
+        if (passwdfile)
+                return users_read_file(users, passwdfile);
+        return users_enumerate(users);
+}
+
+/* returns 1 and the words if the user is known, 0 if it has to be
+   looked up */
+int
+users_lookup(struct pwq_users *users, const char *name,
+        const char **words, size_t *gecoslen)
+{
+        struct users_entry *e;
+
+        e = find_slot(users->slots, users->nslots,
+                siphash24(users->sipkey, name, strlen(name)), name);
+        if (e->name == NULL)
+                return 0;
+
+        *words = e->words;
+        *gecoslen = e->gecoslen;
+        return 1;
+}
+
+/*
+ * Copyright (c) Red Hat, Inc, 2026
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, and the entire permission notice in its entirety,
+ *    including the disclaimer of warranties.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote
+ *    products derived from this software without specific prior
+ *    written permission.
+ *
+ * ALTERNATIVELY, this product may be distributed under the terms of
+ * the GNU General Public License version 2 or later, in which case the
+ * provisions of the GPL are required INSTEAD OF the above restrictions.
+ *
+ * THIS SOFTWARE IS PROVIDED `AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */